@@ -19,39 +19,167 @@ ostream& operator<<(ostream& os, const Area& a)
     return os;
 }
 
-/*
- * Until we test this, we shouldn't define it since when we use the standard
- * libraries it will call this equality operator.
-*/
-bool operator==(const Area& a,const Area& b)
+void Area::buildIndex()
 {
-    int i = 0;
-    bool clockWise = true;
-    bool countWise = true;
+    vector<Coord> tops;
+    vector<Coord> bottoms;
 
-    if (a.size() != b.size()) return false;
-    if (a.size() == 0) return true;
+    slabs.clear();
+    crossings.clear();
 
-    //find the point a common point between the two areas
-    for (; i < b.size() && a[0]->line != b[i]->line; i++);
+    // Find the vertical segments, with tops[i] being the smaller y value
+    for (int i = 0; i < size(); i++)
+    {
+        const Line& line = *(*this)[i]->line;
 
-    //if we've reached the end and there are no matches
-    if (i == b.size()-1 && a[0]->line != b[i]->line) return false;
+        for (int j = 1; j < line.size(); j++)
+        {
+            if (line[j-1].x == line[j].x && line[j-1].y != line[j].y)
+            {
+                tops.push_back(Coord(line[j].x, min(line[j-1].y, line[j].y)));
+                bottoms.push_back(Coord(line[j].x, max(line[j-1].y, line[j].y)));
+                slabs.push_back(tops.back().y);
+                slabs.push_back(bottoms.back().y);
+            }
+        }
+    }
 
-    //run find the first element in clockwise roation that is not equal,
-    //then do the same for counterclockwise.
-    for (int j=0;j<a.size()&& clockWise;j++)
+    sort(slabs.begin(), slabs.end());
+    slabs.erase(unique(slabs.begin(), slabs.end()), slabs.end());
+    crossings.resize(slabs.size());
+
+    // Add each segment to every slab between its ends
+    for (int i = 0; i < tops.size(); i++)
     {
-        if (a[j]->line!=b[(i+j)%a.size()]->line) clockWise = false;
+        int first = lower_bound(slabs.begin(), slabs.end(), tops[i].y) - slabs.begin();
+        int last = lower_bound(slabs.begin(), slabs.end(), bottoms[i].y) - slabs.begin();
+
+        for (int j = first; j < last; j++)
+            crossings[j].push_back(tops[i].x);
     }
 
-    for (int j=0;j<(a.size())&& countWise;j++)
+    for (int i = 0; i < crossings.size(); i++)
+        sort(crossings[i].begin(), crossings[i].end());
+
+    hasIndex = true;
+}
+
+// Like Game::isInArea(), count the vertical segments to the left of the point
+// that have minY < y <= maxY. Those are exactly the ones in the slab above y.
+bool Area::contains(Coord position) const
+{
+    int slab = lower_bound(slabs.begin(), slabs.end(), position.y) - slabs.begin() - 1;
+
+    // Above or below all the segments
+    if (slab < 0 || slab+1 >= slabs.size())
+        return false;
+
+    const vector<int>& xs = crossings[slab];
+
+    return (lower_bound(xs.begin(), xs.end(), position.x) - xs.begin())%2;
+}
+
+// Areasets are sorted, so equal ones have the same pointers in the same order
+size_t AreasetHash::operator()(const Areaset& set) const
+{
+    size_t hash = 2166136261u;
+
+    for (int i = 0; i < set.size(); i++)
+        hash = (hash ^ (reinterpret_cast<size_t>(set[i]) >> 3)) * 16777619u;
+
+    return hash ^ (hash >> 15);
+}
+
+// Compare the lines of the area going around from index i in direction dir
+// (1 or -1) with those going around from index j in direction jdir. Lines are
+// ordered by address like LineCmp.
+static int compareRotations(const Area& a, int i, int dir, int j, int jdir)
+{
+    int n = a.size();
+
+    for (int k = 0; k < n; k++)
     {
-        if (a[j]->line!=b[abs(i-j)%(a.size())]->line) countWise = false;
+        const Line* x = a[((i+dir*k)%n+n)%n]->line;
+        const Line* y = a[((j+jdir*k)%n+n)%n]->line;
+
+        if (x != y)
+            return (x < y)?-1:1;
     }
 
-    // the areas match if at least one of the checks didnt find any differences
-    return (clockWise || countWise);
+    return 0;
+}
+
+void Area::canonicalize()
+{
+    int n = size();
+    int best = -1;
+    int bestDir = 1;
+    const Line* smallest = NULL;
+
+    for (int i = 0; i < n; i++)
+        if (!smallest || (*this)[i]->line < smallest)
+            smallest = (*this)[i]->line;
+
+    // A line is in an area at most twice, so there are only a few places the
+    // smallest rotation could start
+    for (int i = 0; i < n; i++)
+    {
+        if ((*this)[i]->line != smallest)
+            continue;
+
+        for (int dir = 1; dir >= -1; dir -= 2)
+        {
+            if (best == -1 || compareRotations(*this, i, dir, best, bestDir) < 0)
+            {
+                best = i;
+                bestDir = dir;
+            }
+        }
+    }
+
+    // Put it in that order
+    vector<Connection*> rotated(n);
+
+    for (int k = 0; k < n; k++)
+        rotated[k] = (*this)[((best+bestDir*k)%n+n)%n];
+
+    vector<Connection*>::operator=(rotated);
+
+    // 64-bit FNV-1a of the lines in order
+    key = 14695981039346656037ULL;
+
+    for (int k = 0; k < n; k++)
+    {
+        key ^= reinterpret_cast<size_t>((*this)[k]->line);
+        key *= 1099511628211ULL;
+    }
+
+    isCanonical = true;
+}
+
+bool operator==(const Area& a,const Area& b)
+{
+    if (a.size() != b.size()) return false;
+
+    // Canonical areas will be in exactly the same order if they're equal
+    if (a.canonical() && b.canonical())
+    {
+        if (a.hash() != b.hash())
+            return false;
+
+        for (int i = 0; i < a.size(); i++)
+            if (a[i]->line != b[i]->line)
+                return false;
+
+        return true;
+    }
+
+    Area first(a);
+    Area second(b);
+    first.canonicalize();
+    second.canonicalize();
+
+    return first == second;
 }
 
 bool operator!=(const Area& a,const Area& b)
@@ -0,0 +1,483 @@
+/*
+*   Time the parts of the A-Checker the GUI and AI use the most
+*
+*   Usage: bench                          Print times as CSV
+*          bench baseline.csv [percent]   Compare against saved times, failing
+*                                         if any got slower by more than the
+*                                         percent (default 10) plus how much
+*                                         its own tries varied
+*
+*   Games start with the spots on a grid and are played to several depths by
+*   drawing small loops and straight lines between neighboring spots in a
+*   fixed random order, which doesn't need the AI to find the lines.
+*/
+#include <map>
+#include <ctime>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <iostream>
+#include <algorithm>
+#include "../headers/game.h"
+
+using namespace std;
+
+// Run each benchmark for at least this long, taking the fastest of so many
+// tries to get a stable time
+static const double minSeconds = 0.05;
+static const int tries = 7;
+
+// Times slower than the baseline are measured again after everything else up
+// to this many times, keeping the fastest, before they count as slower
+static const int retries = 3;
+
+// Distance between spots, even so the middle nodes land on whole pixels
+static const int spacing = 60;
+
+// Needs access to the nodes
+class Bench : public Game
+{
+    public:
+        Bench() :Game() { }
+
+        // Spots on a grid and the lines that could be drawn between neighbors
+        void setup(int spots, vector<Line>& moves);
+
+        // Draw up to so many of the moves, skipping ones that can't be
+        // drawn anymore, and leave the rest in moves
+        void play(int count, vector<Line>& moves);
+
+        // The things being timed, each done so many times
+        void runUpdateAreas(long times);
+        void runWalk(long times);
+        void runIsInArea(long times);
+        void runConnectable(long times);
+        void runCrosses(long times);
+        void runFindNode(long times);
+        void runGameEnded(long times);
+        void runCopy(long times);
+
+        // The areas on either side of the nodes
+        vector<const Area*> nodeAreas() const;
+};
+
+void Bench::setup(int spots, vector<Line>& moves)
+{
+    int columns = 1;
+
+    while (columns*columns < spots)
+        ++columns;
+
+    for (int i = 0; i < spots; i++)
+        insertNode(Coord(spacing*(1 + i%columns), spacing*(1 + i/columns)));
+
+    for (int i = 0; i < spots; i++)
+    {
+        const Coord from = nodes[i]->getLoci();
+        const int row = i/columns;
+        Line line;
+
+        // A small loop leaving right and coming back from the left, above the
+        // spot on even rows and below it on odd rows so the spots in each pair
+        // of rows can still be connected to each other
+        const int side = (row%2 == 0)?-spacing/3:spacing/3;
+
+        line.push_back(from);
+        line.push_back(Coord(from.x + spacing/4, from.y));
+        line.push_back(Coord(from.x + spacing/4, from.y + side));
+        line.push_back(Coord(from.x - spacing/4, from.y + side));
+        line.push_back(Coord(from.x - spacing/4, from.y));
+        line.push_back(from);
+        moves.push_back(line);
+
+        // To the next spot to the right
+        line.clear();
+        line.push_back(from);
+        line.push_back(Coord(from.x + spacing, from.y));
+
+        if (i%columns != columns-1 && i+1 < spots)
+            moves.push_back(line);
+
+        // To the spot below, if the loops are out of the way
+        line.back() = Coord(from.x, from.y + spacing);
+
+        if (row%2 == 0 && i+columns < spots)
+            moves.push_back(line);
+    }
+
+    // Fisher-Yates with a fixed seed so every run plays the same games
+    srand(1);
+
+    for (int i = moves.size()-1; i > 0; i--)
+        swap(moves[i], moves[rand()%(i+1)]);
+
+    updateAreas();
+}
+
+// Where to put the middle node of one of the lines from setup(), halfway along
+// the middle segment
+static Coord middleOf(const Line& line)
+{
+    const Coord& a = line[(line.size()-1)/2];
+    const Coord& b = line[line.size()/2];
+
+    return Coord((a.x + b.x)/2, (a.y + b.y)/2);
+}
+
+void Bench::play(int count, vector<Line>& moves)
+{
+    vector<Line> left;
+
+    for (int i = 0; i < moves.size(); i++)
+    {
+        const Line& line = moves[i];
+
+        if (count > 0)
+        {
+            try
+            {
+                doMove(line, middleOf(line));
+                --count;
+                continue;
+            }
+            catch (...)
+            {
+                // Dead spot or not in the same region anymore
+                continue;
+            }
+        }
+
+        left.push_back(line);
+    }
+
+    moves = left;
+}
+
+void Bench::runUpdateAreas(long times)
+{
+    for (long i = 0; i < times; i++)
+        updateAreas();
+}
+
+void Bench::runWalk(long times)
+{
+    for (long i = 0; i < times; i++)
+    {
+        vector<Area*> found;
+        AreaTable unique;
+
+        for (int j = 0; j < nodes.size(); j++)
+            nodes[j]->walk(found, unique);
+
+        for (int j = 0; j < found.size(); j++)
+            delete found[j];
+    }
+}
+
+vector<const Area*> Bench::nodeAreas() const
+{
+    vector<const Area*> all;
+
+    for (int i = 0; i < nodes.size(); i++)
+        if (!nodes[i]->dead())
+            for (int side = 0; side < 2; side++)
+                for (int j = 0; j < nodes[i]->areasets[side]->size(); j++)
+                    all.push_back((*nodes[i]->areasets[side])[j]);
+
+    return all;
+}
+
+void Bench::runIsInArea(long times)
+{
+    const vector<const Area*> all = nodeAreas();
+
+    for (long i = 0; i < times; i++)
+    {
+        // Points between the spots so they're inside some areas and not others
+        const Coord& near = nodes[i%nodes.size()]->getLoci();
+        isInArea(*all[i%all.size()], Coord(near.x + spacing/4, near.y + spacing/3));
+    }
+}
+
+void Bench::runConnectable(long times)
+{
+    for (long i = 0; i < times; i++)
+        connectable(*nodes[i%nodes.size()], *nodes[(i/nodes.size() + i)%nodes.size()]);
+}
+
+void Bench::runCrosses(long times)
+{
+    const Segments& drawn = segments();
+
+    for (long i = 0; i < times; i++)
+    {
+        // Right or down to about where the next spot is
+        const Coord& from = nodes[i%nodes.size()]->getLoci();
+        const Coord to = (i%2 == 0)?Coord(from.x + spacing, from.y):Coord(from.x, from.y + spacing);
+
+        drawn.crosses(from, to);
+    }
+}
+
+void Bench::runFindNode(long times)
+{
+    for (long i = 0; i < times; i++)
+        findNode(nodes[i%nodes.size()]->getLoci());
+}
+
+void Bench::runGameEnded(long times)
+{
+    for (long i = 0; i < times; i++)
+        gameEnded();
+}
+
+void Bench::runCopy(long times)
+{
+    for (long i = 0; i < times; i++)
+        Game copy(*this);
+}
+
+// Seconds to do it so many times
+static double timeRun(Bench& game, void (Bench::*run)(long), long times)
+{
+    const clock_t start = clock();
+    (game.*run)(times);
+    return double(clock() - start)/CLOCKS_PER_SEC;
+}
+
+// Each move is drawn in a different copy with its areas up to date like in a
+// real game, so only the doMove() calls are timed
+static double timeDoMove(const Bench& game, const vector<Line>& moves, long times)
+{
+    vector<Game*> copies;
+
+    for (long i = 0; i < times; i++)
+    {
+        copies.push_back(new Game(game));
+        copies.back()->updateAreas();
+    }
+
+    const clock_t start = clock();
+
+    for (long i = 0; i < times; i++)
+    {
+        const Line& line = moves[i%moves.size()];
+
+        try
+        {
+            copies[i]->doMove(line, middleOf(line));
+        }
+        catch (...)
+        {
+            // Rejected moves are timed too since checking is most of it
+        }
+    }
+
+    const double seconds = double(clock() - start)/CLOCKS_PER_SEC;
+
+    for (long i = 0; i < times; i++)
+        delete copies[i];
+
+    return seconds;
+}
+
+// The time of one benchmark and how much it varied
+struct Timing
+{
+    double ns;    // Each time, from the fastest try
+    double noise; // Percent the median try was slower than the fastest
+
+    Timing(double ns = 0, double noise = 0) :ns(ns), noise(noise) { }
+};
+
+// It's run more times until it takes long enough, and then the fastest of a
+// few tries is used since anything else running only makes it slower. How far
+// the median is from that says how much to trust it.
+static Timing measure(Bench& game, void (Bench::*run)(long), const vector<Line>* moves)
+{
+    long times = 1;
+    vector<double> seconds(1, 0.0);
+
+    while (seconds[0] < minSeconds)
+    {
+        times *= 2;
+        seconds[0] = moves?timeDoMove(game, *moves, times):timeRun(game, run, times);
+    }
+
+    for (int i = 1; i < tries; i++)
+        seconds.push_back(moves?timeDoMove(game, *moves, times):timeRun(game, run, times));
+
+    sort(seconds.begin(), seconds.end());
+
+    const double best = seconds.front();
+    const double median = seconds[seconds.size()/2];
+
+    return Timing(best*1e9/times, (best > 0)?100*(median - best)/best:0);
+}
+
+// name,spots,depth -> time
+typedef map<string, Timing> Results;
+
+// What this run is compared against, if anything
+static Results baseline;
+static double percent = 10;
+
+// Percent slower than the baseline, or 0 if it's not in it
+static double change(const string& key, const Timing& t)
+{
+    const Results::const_iterator old = baseline.find(key);
+
+    if (old == baseline.end() || old->second.ns <= 0)
+        return 0;
+
+    return 100*(t.ns - old->second.ns)/old->second.ns;
+}
+
+// Allowing for how much its tries varied, since a noisy time could be that
+// much slower anyway
+static bool slower(const string& key, const Timing& t)
+{
+    return change(key, t) > percent + t.noise;
+}
+
+// Time it unless only some are being timed and it's not one of them
+static void record(Results& results, const Results* only, const string& name,
+    int spots, int depth, Bench& game, void (Bench::*run)(long),
+    const vector<Line>* moves = NULL)
+{
+    ostringstream key;
+    key << name << "," << spots << "," << depth;
+
+    if (!only || only->count(key.str()))
+        results[key.str()] = measure(game, run, moves);
+}
+
+// Play the games and time everything, or only those in only
+static void runAll(Results& results, const Results* only)
+{
+    const int sizes[] = { 5, 10, 20, 50, 100 };
+    const int sizeCount = sizeof(sizes)/sizeof(sizes[0]);
+
+    for (int s = 0; s < sizeCount; s++)
+    {
+        const int spots = sizes[s];
+        const int depths[] = { 0, spots/4, spots/2, spots };
+        Bench game;
+        vector<Line> moves;
+        int depth = 0;
+
+        game.setup(spots, moves);
+
+        for (int d = 0; d < 4; d++)
+        {
+            game.play(depths[d] - depth, moves);
+            depth = game.moves();
+            game.updateAreas();
+
+            // Walking circuits gets exponentially slower with more loops
+            const bool walk = spots <= 20 || depth == 0;
+
+            record(results, only, "updateAreas", spots, depth, game, &Bench::runUpdateAreas);
+
+            if (walk)
+                record(results, only, "walk", spots, depth, game, &Bench::runWalk);
+
+            if (!game.nodeAreas().empty())
+                record(results, only, "isInArea", spots, depth, game, &Bench::runIsInArea);
+            record(results, only, "connectable", spots, depth, game, &Bench::runConnectable);
+            record(results, only, "crosses", spots, depth, game, &Bench::runCrosses);
+            record(results, only, "findNode", spots, depth, game, &Bench::runFindNode);
+            record(results, only, "gameEnded", spots, depth, game, &Bench::runGameEnded);
+            record(results, only, "copy", spots, depth, game, &Bench::runCopy);
+            if (!moves.empty())
+                record(results, only, "doMove", spots, depth, game, NULL, &moves);
+        }
+    }
+}
+
+// Only the times are saved, so the noise is that of the new run
+static bool load(const char* filename, Results& results)
+{
+    ifstream file(filename);
+    string line;
+
+    if (!file)
+        return false;
+
+    while (getline(file, line))
+    {
+        const string::size_type comma = line.rfind(',');
+
+        if (comma != string::npos && line.compare(0, 5, "name,") != 0)
+            results[line.substr(0, comma)] = Timing(atof(line.substr(comma+1).c_str()));
+    }
+
+    return !results.empty();
+}
+
+int main(int argc, char* argv[])
+{
+    Results results;
+
+    // Before spending minutes timing everything
+    if (argc > 1 && !load(argv[1], baseline))
+    {
+        cerr << "no times in " << argv[1] << endl;
+        return 2;
+    }
+
+    if (argc > 2)
+        percent = atof(argv[2]);
+
+    runAll(results, NULL);
+
+    // If the computer was busy for a while, they'll be faster later, while
+    // something that really got slower stays slower
+    for (int i = 0; i < retries; i++)
+    {
+        Results suspects;
+        Results again;
+
+        for (Results::const_iterator j = results.begin(); j != results.end(); ++j)
+            if (slower(j->first, j->second))
+                suspects.insert(*j);
+
+        if (suspects.empty())
+            break;
+
+        runAll(again, &suspects);
+
+        for (Results::const_iterator j = again.begin(); j != again.end(); ++j)
+            if (j->second.ns < results[j->first].ns)
+                results[j->first] = j->second;
+    }
+
+    cout << "name,spots,depth,ns" << endl;
+
+    for (Results::const_iterator i = results.begin(); i != results.end(); ++i)
+        cout << i->first << "," << fixed << setprecision(3) << i->second.ns << endl;
+
+    if (argc < 2)
+        return 0;
+
+    // Compare against the baseline
+    int regressions = 0;
+
+    for (Results::const_iterator i = results.begin(); i != results.end(); ++i)
+    {
+        if (slower(i->first, i->second))
+        {
+            cerr << "slower: " << i->first << " " << baseline[i->first].ns << " ns -> "
+                 << i->second.ns << " ns (+" << change(i->first, i->second) << "%, noise "
+                 << i->second.noise << "%)" << endl;
+            ++regressions;
+        }
+    }
+
+    cerr << regressions << " regressions over " << percent << "%" << endl;
+
+    return (regressions > 0)?1:0;
+}
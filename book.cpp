@@ -0,0 +1,57 @@
+/*
+ * Made by the book tool with 200 ms per move and up to 6 spots, don't change it by hand
+ */
+#include "headers/solver.h"
+
+const char* const Solver::book[] =
+{
+    "0.0.0.0.0.2}!",
+    "0.0.0.0.2}!",
+    "0.0.0.1}!",
+    "0}0.0.0.0.2}!",
+    "A.BCB1}C.0}A.0.0}!",
+    "A1A1.B1B1.C1C1}!",
+    "A1A2.B1B2.0}!",
+    "AB.C1C1.0}AB.2}!",
+    "AB.C1C1.2}AB.0.0}!",
+    "AB.CC1.0}AB.0.0}!",
+    "AB.CC1.0}AB.0}0}!",
+    "AB.CD1DC1}AB.0}0}!",
+    "AB.CDEFEDC1}AB.0}F.0}!",
+    "AB1BC11CA22}!",
+    "ABA1.0.0.0}B.0}!",
+    "ABA1.C1C1.0}DE}B.DE}!",
+    "ABA1.C1C1}B.22}!",
+    "ABA1.C1C1}B.D1D2}!",
+    "ABA1.C1C1}DE}B.DE}!",
+    "ABA1.CD1.0}CD}B.2}!",
+    "ABA11}B.0.0.0}!",
+    "ABA1}B.C11C11}!",
+    "ABA1}B.CDE1EDC11}!",
+    "ABA1}CD}B.EFGHGFE1}H.CD}!",
+    "ABA1}CD}E.CD}B.EF1F1}!",
+    "ABC1CBA1.0.2}!",
+    "ABC1CBA1.D1D2}!",
+    "ABC1CBA12.0}!",
+    "ABC1CBA12}12}!",
+    "ABC1CBA22.D1D2}!",
+    "ABCA1}DBCD1.E1E1}!",
+    "ABCDA11}BDC.E1E1}!",
+    "ABCDCBAEF1FE1}GH}D.GH}!",
+    "ABCDE1EDCBA1.22}!",
+    "ABCDE1EDCBA2.0}!",
+    "ABCDECBA1.F1F2}DE}!",
+    "ABCDEFCBA1}DFE}12}!",
+    "ABCDEFEDCBA1}F12}!",
+    "ABCD}ADCB.EFE1}F.G1G1}!",
+    "ABCD}EFE1}F.ADC1B2}!",
+    "AB}AB.0.0.0}!",
+    "AB}AB.CD1C1.0}D.0}!",
+    "AB}AB2.C1C1.0}!",
+    "AB}AB2.C1C1.D1D1}!",
+    "AB}AB}C1C1.0.0.2}!",
+    "AB}AB}C1C1.0.2.2}!",
+    "AB}AB}CD}CD.EFGGFE1.0}!",
+    "AB}CD}CD2.AB2.E1E1}!",
+    NULL
+};
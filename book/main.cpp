@@ -0,0 +1,149 @@
+/*
+*   Work out the book of positions the AI can't search in time near the start
+*   of a game, and write it out as book.cpp
+*
+*   Usage: book [milliseconds per move] [most spots] > ../book.cpp
+*
+*   For each number of spots, this goes through the games the AI could play
+*   against any moves, where it either wins from the start or after the other
+*   player's mistake. Wherever searching for that many milliseconds doesn't
+*   find who wins, it searches all the way, and if the player to move wins it
+*   puts the position the winning move leaves in the book. It only has to go
+*   on past the positions that weren't worked out in time, since the search
+*   of the others already knows everything after them. Searching all the way
+*   takes minutes near the start of bigger games, so this takes a while.
+*/
+#include <set>
+#include <string>
+#include <cstdlib>
+#include <iostream>
+#include "../headers/solver.h"
+
+using namespace std;
+
+// Mistakes in the first two moves, since a person may not play the best move
+// and then the AI is the one who can win
+static const int mistakes = 2;
+
+static int milliseconds;
+static set<string> explored; // Positions already gone through
+static set<string> losing;   // And ones only looked at for mistakes
+static set<string> lost;     // The book
+
+// The positions after each move, once each
+static vector<Position> after(const Position& p)
+{
+    const vector<AbstractMove> moves = p.moves();
+    vector<Position> positions;
+    set<string> keys;
+
+    for (int i = 0; i < moves.size(); i++)
+    {
+        const Position next = p.play(moves[i]);
+
+        if (keys.insert(next.key()).second)
+            positions.push_back(next);
+    }
+
+    return positions;
+}
+
+// Go through a position that many moves into a game, where the player to move
+// is known to win (1) or lose (-1) or it isn't known yet (0), only if the
+// player to move wins when it's after a mistake
+static void explore(const Position& p, int moves, int known, bool mistake)
+{
+    const string key = p.key();
+
+    if (p.ended() || explored.count(key) || (mistake && losing.count(key)))
+        return;
+
+    Solver quick(milliseconds, 18, false);
+    vector<AbstractMove> ranked = quick.rank(p);
+    int value = quick.value();
+    const bool inTime = (value != 0);
+
+    // Only the winner needs to know which move is best
+    if (!inTime && known == -1)
+        value = -1;
+
+    if (value == 0)
+    {
+        Solver all(1 << 30, 20, false);
+
+        ranked = all.rank(p);
+        value = all.value();
+
+        cerr << "after " << moves << " moves " << p << " " << all << endl;
+    }
+
+    if (mistake && value == -1)
+    {
+        losing.insert(key);
+        return;
+    }
+
+    explored.insert(key);
+
+    if (!inTime && value == 1)
+        lost.insert(p.play(ranked.front()).key());
+
+    // The search already knows everything after what it worked out in time
+    if (inTime && moves >= mistakes)
+        return;
+
+    const vector<Position> next = after(p);
+
+    if (value == 1)
+    {
+        explore(p.play(ranked.front()), moves+1, -1, false);
+
+        if (moves < mistakes)
+            for (int i = 0; i < next.size(); i++)
+                explore(next[i], moves+1, 0, true);
+    }
+    else
+    {
+        // The loser can play anything
+        for (int i = 0; i < next.size(); i++)
+            explore(next[i], moves+1, 1, false);
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    milliseconds = (argc > 1)?atoi(argv[1]):200;
+    const int spots = (argc > 2)?atoi(argv[2]):7;
+
+    for (int i = 1; i <= spots; i++)
+        explore(Position(i), 0, 0, false);
+
+    cout << "/*" << endl
+         << " * Made by the book tool with " << milliseconds << " ms per move and up to "
+         << spots << " spots, don't change it by hand" << endl
+         << " */" << endl
+         << "#include \"headers/solver.h\"" << endl
+         << endl
+         << "const char* const Solver::book[] =" << endl
+         << "{" << endl;
+
+    for (set<string>::const_iterator i = lost.begin(); i != lost.end(); ++i)
+    {
+        cout << "    \"";
+
+        for (int j = 0; j < i->size(); j++)
+        {
+            if ((*i)[j] == '"' || (*i)[j] == '\\')
+                cout << '\\';
+
+            cout << (*i)[j];
+        }
+
+        cout << "\"," << endl;
+    }
+
+    cout << "    NULL" << endl
+         << "};" << endl;
+
+    return 0;
+}
@@ -0,0 +1,179 @@
+/*
+*   Showing only the parts of the screen that changed
+*/
+#include <cstring>
+#include <algorithm>
+#include "headers/damage.h"
+
+// Show all of the screen once this much of it, in sixteenths, was damaged
+static const int mostOf = 8;
+
+void Damage::add(int x, int y, int w, int h)
+{
+    if (w <= 0 || h <= 0)
+        return;
+
+    SDL_Rect r;
+    r.x = x;
+    r.y = y;
+    r.w = w;
+    r.h = h;
+    rects.push_back(r);
+}
+
+void Damage::add(const SDL_Rect& r)
+{
+    add(r.x, r.y, r.w, r.h);
+}
+
+void Damage::addAll()
+{
+    everything = true;
+}
+
+void Damage::clear()
+{
+    rects.clear();
+    everything = false;
+}
+
+vector<SDL_Rect> Damage::on(int w, int h) const
+{
+    vector<SDL_Rect> result;
+    long area = 0;
+
+    if (!everything)
+    {
+        for (int i = 0; i < rects.size(); i++)
+        {
+            // SDL_Rect's position is a Sint16 and size a Uint16, so cut it in ints
+            const int left = max<int>(rects[i].x, 0);
+            const int top = max<int>(rects[i].y, 0);
+            const int right = min<int>(rects[i].x + rects[i].w, w);
+            const int bottom = min<int>(rects[i].y + rects[i].h, h);
+
+            if (left < right && top < bottom)
+            {
+                SDL_Rect r;
+                r.x = left;
+                r.y = top;
+                r.w = right - left;
+                r.h = bottom - top;
+                result.push_back(r);
+                area += (long)r.w*r.h;
+            }
+        }
+    }
+
+    // Overlapping ones are counted twice, which only means this happens sooner
+    if (everything || area*16 >= (long)w*h*mostOf)
+    {
+        result.clear();
+
+        if (w > 0 && h > 0)
+        {
+            SDL_Rect r;
+            r.x = 0;
+            r.y = 0;
+            r.w = w;
+            r.h = h;
+            result.push_back(r);
+        }
+    }
+
+    return result;
+}
+
+void Damage::present(SDL_Surface* screen)
+{
+    if (!partial(screen))
+    {
+        SDL_Flip(screen);
+    }
+    else if (!empty())
+    {
+        vector<SDL_Rect> shown = on(screen->w, screen->h);
+
+        if (!shown.empty())
+            SDL_UpdateRects(screen, shown.size(), &shown[0]);
+    }
+
+    clear();
+}
+
+bool Damage::partial(const SDL_Surface* screen)
+{
+    return (screen->flags & (SDL_HWSURFACE|SDL_DOUBLEBUF)) != (SDL_HWSURFACE|SDL_DOUBLEBUF);
+}
+
+bool Damage::difference(SDL_Surface* a, SDL_Surface* b, SDL_Rect& changed)
+{
+    if (!a || !b || a->w != b->w || a->h != b->h ||
+        a->format->BitsPerPixel != b->format->BitsPerPixel)
+        return false;
+
+    if (SDL_LockSurface(a) < 0)
+        return false;
+
+    if (SDL_LockSurface(b) < 0)
+    {
+        SDL_UnlockSurface(a);
+        return false;
+    }
+
+    const int bytes = a->format->BytesPerPixel;
+    const int row = a->w*bytes;
+    const Uint8* pa = static_cast<const Uint8*>(a->pixels);
+    const Uint8* pb = static_cast<const Uint8*>(b->pixels);
+    int top = a->h;
+    int bottom = -1;
+    int left = row;
+    int right = -1;
+
+    for (int y = 0; y < a->h; y++)
+    {
+        const Uint8* ra = pa + y*a->pitch;
+        const Uint8* rb = pb + y*b->pitch;
+
+        if (memcmp(ra, rb, row) == 0)
+            continue;
+
+        top = min(top, y);
+        bottom = y;
+
+        // Only the bytes outside what we already know is different
+        for (int i = 0; i < left && i < row; i++)
+        {
+            if (ra[i] != rb[i])
+            {
+                left = i;
+                break;
+            }
+        }
+
+        for (int i = row - 1; i > right; i--)
+        {
+            if (ra[i] != rb[i])
+            {
+                right = i;
+                break;
+            }
+        }
+    }
+
+    SDL_UnlockSurface(b);
+    SDL_UnlockSurface(a);
+
+    changed.x = changed.y = 0;
+    changed.w = changed.h = 0;
+
+    if (bottom >= 0)
+    {
+        changed.x = left/bytes;
+        changed.y = top;
+        changed.w = right/bytes - left/bytes + 1;
+        changed.h = bottom - top + 1;
+    }
+
+    return true;
+}
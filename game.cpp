@@ -2,10 +2,18 @@
 * Implementation of game class, the AChecker
 */
 
+#include <climits>
 #include "headers/game.h"
 
+// Bits in each word of a partner row
+static const int wordBits = sizeof(unsigned long)*CHAR_BIT;
+
+// Look through the nodes for this many lookups before making the node index
+static const int indexAfter = 8;
+
 Game::Game()
-    :updated(true), moveCount(0)
+    :updated(true), moveCount(0), incremental(true), verify(false),
+    finder(TraceAreas), movableRegions(0), checkedAt(-1), changes(0), segmentsAt(-1), nodesIndexed(false), nodeLookups(0)
 {
 
 }
@@ -16,7 +24,9 @@ Game::Game()
 // on the object you copied from. After copying this and adding to it do you
 // want to update the areas and then check connectable() again.
 Game::Game(const Game& g)
-    :updated(false), nodes(g.nodes.size()), lines(g.lines.size())
+    :updated(false), moveCount(g.moveCount), incremental(g.incremental), verify(g.verify),
+    finder(g.finder), movableRegions(0), checkedAt(-1), changes(0), segmentsAt(-1),
+    nodeGrid(g.nodeGrid), nodesIndexed(g.nodesIndexed), nodeLookups(0), nodes(g.nodes.size()), lines(g.lines.size())
 {
     copy(g);
 }
@@ -26,6 +36,15 @@ Game& Game::operator=(const Game& g)
     cleanup();
 
     updated = false;
+    checkedAt = -1;
+    segmentsAt = -1;
+    nodeGrid = g.nodeGrid; // Nodes keep their indexes
+    nodesIndexed = g.nodesIndexed;
+    nodeLookups = 0;
+    moveCount = g.moveCount;
+    incremental = g.incremental;
+    verify = g.verify;
+    finder = g.finder;
     nodes = vector<Node*>(g.nodes.size());
     lines = vector<Line*>(g.lines.size());
 
@@ -73,10 +92,65 @@ void Game::copy(const Game& g)
     }
 }
 
-void Game::updateAreas()
+Game::Game(const GameState& s)
+    :updated(false), moveCount(s.moves()), incremental(true), verify(false),
+    finder(TraceAreas), movableRegions(0), checkedAt(-1), changes(0), segmentsAt(-1), nodesIndexed(false), nodeLookups(0), nodes(s.nodeCount()), lines(s.lineCount())
+{
+    for (int i = 0; i < s.lineCount(); ++i)
+        lines[i] = new Line(s.line(i));
+
+    for (int i = 0; i < s.nodeCount(); ++i)
+        nodes[i] = new Node(s.loci(i));
+
+    // Connections are added in the same order they were in, so the last one
+    // filled is still the last one
+    for (int i = 0; i < s.nodeCount(); ++i)
+        for (int j = 0; j < 3; ++j)
+            if (s.connectionLine(i, j) != -1)
+                nodes[i]->addConnection(Connection(
+                    lines[s.connectionLine(i, j)],
+                    nodes[s.connectionDest(i, j)]));
+}
+
+GameState Game::state() const
 {
-    Connection* nodeConns;
+    // Indices of each line and node
+    map<const Line*, int> lineIndex;
+    map<const Node*, int> nodeIndex;
+    int points = 0;
+
+    for (int i = 0; i < lines.size(); ++i)
+    {
+        lineIndex[lines[i]] = i;
+        points += lines[i]->size();
+    }
+
+    for (int i = 0; i < nodes.size(); ++i)
+        nodeIndex[nodes[i]] = i;
+
+    GameState s(nodes.size(), lines.size(), points, moveCount);
+
+    for (int i = 0; i < lines.size(); ++i)
+        s.setLine(i, *lines[i]);
+
+    for (int i = 0; i < nodes.size(); ++i)
+    {
+        s.setNode(i, nodes[i]->loci);
+
+        for (int j = 0; j < 3; ++j)
+        {
+            const Connection& con = nodes[i]->connections[j];
+
+            if (con.exists())
+                s.setConnection(i, j, lineIndex[con.line], nodeIndex[con.dest]);
+        }
+    }
+
+    return s;
+}
 
+void Game::updateAreas()
+{
     // We have once again updated the area
     updated = true;
 
@@ -84,10 +158,21 @@ void Game::updateAreas()
 
     // When we unique the areasets, we need a catch-all one
     areasets.push_back(&defaultAreaset);
+    uniqueAreasets.insert(&defaultAreaset);
 
     // Find all Circuits/areas
-    for(int i=0;i<nodes.size();i++)
-        nodes[i]->walk(areas);
+    if (finder == TraceAreas)
+    {
+        set<Connection*> traced;
+
+        for(int i=0;i<nodes.size();i++)
+            nodes[i]->trace(areas, uniqueAreas, traced);
+    }
+    else
+    {
+        for(int i=0;i<nodes.size();i++)
+            nodes[i]->walk(areas, uniqueAreas);
+    }
 
     //create and apply area sets to each node
     for(int i=0;i<nodes.size();i++)
@@ -95,97 +180,454 @@ void Game::updateAreas()
         if(nodes[i]->dead())
             continue;
 
-        Areaset* tempSets[2];
-        tempSets[0] = new Areaset();
-        tempSets[1] = new Areaset();
+        findAreasets(*nodes[i]);
+    }
+
+    refreshPartners();
+}
+
+// The incremental version of updateAreas() used by doMove(). The new line
+// went through one region, so it can only split the region(s) in split. Every
+// other region stays the same except for gaining whichever of the new areas
+// surround it and losing any that are gone. Only the nodes in the split
+// regions have to be recomputed.
+//
+// When walking circuits, every area we already have is still an area, and the
+// only new ones are those going through the new middle node. When tracing
+// faces, the faces going past either end of the new line may have changed, so
+// those are removed and traced again.
+//
+// Everything changed is saved in the record so that undoMove() can put it back.
+void Game::splitAreas(Node& middle, const vector<Areaset*>& split, MoveRecord& record)
+{
+    vector<Area*>& removed = record.removed;
+    vector<Area*>& added = record.added;
+    vector<Node*> redo;
+    map<Areaset*, Coord> samples;
+
+    updated = true;
 
-        nodeConns = nodes[i]->getConnAddr();
-        Coord original = nodes[i]->getLoci();
+    // Find the new Circuits/areas
+    if (finder == TraceAreas)
+    {
+        const Node* a = middle.connections[0].dest;
+        const Node* b = middle.connections[1].dest;
+        set<Connection*> traced;
+        vector<Area*> kept;
 
-        /*
-        * this if statement is only true if on a border, since conn 1
-        * would have to be non null, and dead eliminated dead node
-        */
-        if(nodeConns[1].exists())
+        for (int i = 0; i < areas.size(); i++)
         {
-            if(nodes[i]->vertical())
-            {
-                for(int j=0;j<areas.size();j++)
-                {
-                    // If its above added to the above area set
-                    if (isInArea(*areas[j],Coord(original.x-1, original.y)))
-                        tempSets[0]->push_back(areas[j]);
+            bool changed = false;
 
-                    // If it is below then added to the below area set
-                    if (isInArea(*areas[j],Coord(original.x+1, original.y)))
-                        tempSets[1]->push_back(areas[j]);
-                }
+            for (int j = 0; j < areas[i]->size() && !changed; j++)
+                if ((*areas[i])[j]->dest == a || (*areas[i])[j]->dest == b)
+                    changed = true;
+
+            if (changed)
+            {
+                removed.push_back(areas[i]);
+                uniqueAreas.erase(areas[i]);
             }
             else
             {
-                for(int j=0;j<areas.size();j++)
-                {
-                    // If its left added to the left area set
-                    if (isInArea(*areas[j],Coord(original.x, original.y-1)))
-                        tempSets[0]->push_back(areas[j]);
-
-                    // If it is right then added to the right area set
-                    if (isInArea(*areas[j],Coord(original.x, original.y+1)))
-                        tempSets[1]->push_back(areas[j]);
-                }
+                kept.push_back(areas[i]);
+                traced.insert(areas[i]->begin(), areas[i]->end());
             }
         }
-        else // A node with either one or no connections
+
+        areas = kept;
+
+        // Everything not in one of the faces we kept goes past a, b, or the
+        // new node, so tracing from there finds all the new faces
+        for (int i = 0; i < removed.size(); i++)
+            for (int j = 0; j < removed[i]->size(); j++)
+                (*removed[i])[j]->dest->trace(areas, uniqueAreas, traced);
+
+        middle.trace(areas, uniqueAreas, traced);
+        added.assign(areas.begin() + kept.size(), areas.end());
+    }
+    else
+    {
+        int oldAreas = areas.size();
+        middle.walk(areas, uniqueAreas);
+        added.assign(areas.begin() + oldAreas, areas.end());
+    }
+
+    // Figure out which nodes need recomputing, and get one point in each of
+    // the other regions to check the new areas against. The default areaset
+    // is outside of everything, so the new areas can't surround it.
+    for (int i = 0; i < nodes.size(); i++)
+    {
+        Node& node = *nodes[i];
+
+        if (node.dead())
+            continue;
+
+        if (&node == &middle ||
+            find(split.begin(), split.end(), node.areasets[0]) != split.end() ||
+            find(split.begin(), split.end(), node.areasets[1]) != split.end())
+            redo.push_back(&node);
+
+        if (&node == &middle)
+            continue;
+
+        for (int side = 0; side < 2; side++)
         {
-            for(int j=0;j<areas.size();j++)
-            {
-                if(isInArea(*areas[j],original))
-                {
-                    // In "both directions" we're in this area. If we don't do
-                    // this for both [0] and [1], we're always in the default
-                    // area and can connect to points outside of this area if
-                    // one of their areas is the default area.
-                    tempSets[0]->push_back(areas[j]);
-                    tempSets[1]->push_back(areas[j]);
-                }
-            }
+            Areaset* set = node.areasets[side];
+
+            if (set != &defaultAreaset && samples.find(set) == samples.end() &&
+                find(split.begin(), split.end(), set) == split.end())
+                samples[set] = sidePoint(node, side);
         }
+    }
 
-        /*
-        * This sorts the area sets, does NOT add if duplicate
-        * And then applies them to the node
-        */
-        sort(tempSets[0]->begin(),tempSets[0]->end());
-        sort(tempSets[1]->begin(),tempSets[1]->end());
+    // Update the regions that weren't split
+    for (map<Areaset*, Coord>::iterator it = samples.begin(); it != samples.end(); ++it)
+    {
+        Areaset& set = *it->first;
 
-        vector<Areaset*>::iterator itA=find_if(areasets.begin(),areasets.end(),
-            PointerFind<Areaset>(*tempSets[0]));
+        // It'll be in a different place in the hash table once it's changed
+        uniqueAreasets.erase(&set);
+        record.changed.push_back(make_pair(&set, set));
 
-        if(itA==areasets.end())
+        for (int j = 0; j < removed.size(); j++)
         {
-            areasets.push_back(tempSets[0]);
+            Areaset::iterator gone = find(set.begin(), set.end(), removed[j]);
+
+            if (gone != set.end())
+                set.erase(gone);
+        }
+
+        for (int j = 0; j < added.size(); j++)
+            if (isInArea(*added[j], it->second))
+                set.push_back(added[j]);
+
+        sort(set.begin(), set.end());
+        uniqueAreasets.insert(&set);
+    }
+
+    // Now recompute the nodes that were in the split region(s). The ends of
+    // the new line are saved too since they may have died, leaving their
+    // areasets as they were.
+    int oldAreasets = areasets.size();
+
+    for (int i = 0; i < 2; i++)
+        if (find(redo.begin(), redo.end(), middle.connections[i].dest) == redo.end())
+            redo.push_back(middle.connections[i].dest);
+
+    for (int i = 0; i < redo.size(); i++)
+    {
+        MoveRecord::NodeAreasets saved = { redo[i], { redo[i]->areasets[0], redo[i]->areasets[1] } };
+
+        if (redo[i] != &middle)
+            record.nodeSets.push_back(saved);
+
+        if (!redo[i]->dead())
+            findAreasets(*redo[i]);
+    }
+
+    // Get rid of any areasets only dead nodes (or nothing) use anymore
+    set<Areaset*> used;
+    vector<Areaset*> keep;
+
+    for (int i = 0; i < nodes.size(); i++)
+    {
+        if (!nodes[i]->dead())
+        {
+            used.insert(nodes[i]->areasets[0]);
+            used.insert(nodes[i]->areasets[1]);
+        }
+    }
+
+    for (int i = 0; i < areasets.size(); i++)
+    {
+        if (areasets[i] == &defaultAreaset || used.find(areasets[i]) != used.end())
+        {
+            keep.push_back(areasets[i]);
+
+            if (i >= oldAreasets)
+                record.addedSets.push_back(areasets[i]);
         }
         else
         {
-            delete tempSets[0];
-            tempSets[0]=*itA;
+            uniqueAreasets.erase(areasets[i]);
+
+            if (i >= oldAreasets)
+                delete areasets[i];
+            else
+                record.removedSets.push_back(areasets[i]);
         }
+    }
+
+    areasets = keep;
+
+    // Only the ends of the line, which lost a life, the new node, and nodes
+    // that ended up on different areasets can have different partners
+    vector<Node*> changed(1, &middle);
+
+    for (int i = 0; i < record.nodeSets.size(); i++)
+    {
+        const MoveRecord::NodeAreasets& saved = record.nodeSets[i];
+
+        if (saved.node == middle.connections[0].dest || saved.node == middle.connections[1].dest ||
+            saved.sets[0] != saved.node->areasets[0] || saved.sets[1] != saved.node->areasets[1])
+            changed.push_back(saved.node);
+    }
+
+    refreshPartners(changed);
+
+    // The removed areas and areasets are deleted once the record is
+    // forgotten, which also keeps their addresses from being reused while
+    // the old areasets still point at them
+    record.saved = true;
+}
+
+// Put back the areas from before splitAreas() in the reverse order they were
+// changed
+void Game::restoreAreas(MoveRecord& record)
+{
+    for (int i = 0; i < record.nodeSets.size(); i++)
+        record.nodeSets[i].node->setAreasets(record.nodeSets[i].sets);
 
-        vector<Areaset*>::iterator itB=find_if(areasets.begin(),areasets.end(),
-            PointerFind<Areaset>(*tempSets[1]));
+    vector<Areaset*> keep;
 
-        if(itB==areasets.end())
+    for (int i = 0; i < areasets.size(); i++)
+    {
+        if (find(record.addedSets.begin(), record.addedSets.end(), areasets[i]) ==
+            record.addedSets.end())
         {
-            areasets.push_back(tempSets[1]);
+            keep.push_back(areasets[i]);
         }
         else
         {
-            delete tempSets[1];
-            tempSets[1]=*itB;
+            uniqueAreasets.erase(areasets[i]);
+            delete areasets[i];
+        }
+    }
+
+    for (int i = 0; i < record.removedSets.size(); i++)
+    {
+        keep.push_back(record.removedSets[i]);
+        uniqueAreasets.insert(record.removedSets[i]);
+    }
+
+    areasets = keep;
+
+    for (int i = 0; i < record.changed.size(); i++)
+    {
+        Areaset* set = record.changed[i].first;
+
+        uniqueAreasets.erase(set);
+        *set = record.changed[i].second;
+        uniqueAreasets.insert(set);
+    }
+
+    // The added areas are always the last ones
+    for (int i = 0; i < record.added.size(); i++)
+    {
+        uniqueAreas.erase(record.added[i]);
+        delete record.added[i];
+    }
+
+    areas.resize(areas.size() - record.added.size());
+
+    for (int i = 0; i < record.removed.size(); i++)
+    {
+        areas.push_back(record.removed[i]);
+        uniqueAreas.insert(record.removed[i]);
+    }
+
+    record = MoveRecord(record.middle);
+}
+
+// Once the areas have all been updated, the saved changes can't be put back
+// anymore, so delete anything they were keeping
+void Game::forgetAreaChanges()
+{
+    for (int i = 0; i < history.size(); i++)
+    {
+        MoveRecord& record = history[i];
+
+        if (!record.saved)
+            continue;
+
+        for (int j = 0; j < record.removed.size(); j++)
+            delete record.removed[j];
+
+        for (int j = 0; j < record.removedSets.size(); j++)
+            delete record.removedSets[j];
+
+        record = MoveRecord(record.middle);
+    }
+}
+
+// Determine which areas are on each side of the node and point it at the
+// matching areasets
+void Game::findAreasets(Node& node)
+{
+    Areaset* tempSets[2];
+    tempSets[0] = new Areaset();
+    tempSets[1] = new Areaset();
+
+    /*
+    * this if statement is only true if on a border, since conn 1
+    * would have to be non null, and dead eliminated dead node
+    */
+    if(node.connections[1].exists())
+    {
+        // If vertical, [0] is the left and [1] the right. Otherwise, [0] is
+        // above and [1] below.
+        Coord first = sidePoint(node, 0);
+        Coord second = sidePoint(node, 1);
+
+        for(int j=0;j<areas.size();j++)
+        {
+            if (isInArea(*areas[j],first))
+                tempSets[0]->push_back(areas[j]);
+
+            if (isInArea(*areas[j],second))
+                tempSets[1]->push_back(areas[j]);
+        }
+    }
+    else // A node with either one or no connections
+    {
+        Coord original = node.getLoci();
+
+        for(int j=0;j<areas.size();j++)
+        {
+            if(isInArea(*areas[j],original))
+            {
+                // In "both directions" we're in this area. If we don't do
+                // this for both [0] and [1], we're always in the default
+                // area and can connect to points outside of this area if
+                // one of their areas is the default area.
+                tempSets[0]->push_back(areas[j]);
+                tempSets[1]->push_back(areas[j]);
+            }
         }
+    }
+
+    /*
+    * This sorts the area sets, does NOT add if duplicate
+    * And then applies them to the node
+    */
+    sort(tempSets[0]->begin(),tempSets[0]->end());
+    sort(tempSets[1]->begin(),tempSets[1]->end());
+
+    tempSets[0] = uniqueAreaset(tempSets[0]);
+    tempSets[1] = uniqueAreaset(tempSets[1]);
+
+    node.setAreasets(tempSets);
+}
 
-        nodes[i]->setAreasets(tempSets);
+// Returns the areaset equal to this one if we already have it, deleting the
+// one passed in. Otherwise, this one is added and returned.
+Areaset* Game::uniqueAreaset(Areaset* set)
+{
+    Areaset* found = uniqueAreasets.find(*set);
+
+    if(!found)
+    {
+        areasets.push_back(set);
+        uniqueAreasets.insert(set);
+        return set;
     }
+
+    delete set;
+    return found;
+}
+
+// Nodes on a border are in different areas on each side. For these we look
+// one pixel to the left/right of vertical ones and above/below horizontal
+// ones. Otherwise, this is just where the node is.
+Coord Game::sidePoint(const Node& node, int side) const
+{
+    Coord point = node.getLoci();
+    int offset = (side == 0)?-1:1;
+
+    if (node.connections[1].exists())
+    {
+        if (node.vertical())
+            point.x += offset;
+        else
+            point.y += offset;
+    }
+
+    return point;
+}
+
+void Game::incrementalAreas(bool enabled, bool verifyAreas)
+{
+    incremental = enabled;
+    verify = verifyAreas;
+}
+
+void Game::areaFinder(AreaFinder f)
+{
+    finder = f;
+    updated = false;
+}
+
+// Used for verifying incremental updates. The other game must be a copy of this
+// one with its areas freshly updated. Areas are compared by the coordinates of
+// their lines since the copy has its own lines.
+bool Game::sameAreas(const Game& g) const
+{
+    if (areas.size() != g.areas.size() || nodes.size() != g.nodes.size())
+        return false;
+
+    for (int i = 0; i < nodes.size(); i++)
+    {
+        for (int j = i; j < nodes.size(); j++)
+            if (connectable(*nodes[i], *nodes[j]) !=
+                g.connectable(*g.nodes[i], *g.nodes[j]))
+                return false;
+
+        if (nodes[i]->dead())
+            continue;
+
+        // The areas on each side should also be the same
+        for (int side = 0; side < 2; side++)
+        {
+            const Areaset& mine = *nodes[i]->areasets[side];
+            const Areaset& theirs = *g.nodes[i]->areasets[side];
+
+            if (mine.size() != theirs.size())
+                return false;
+
+            for (int j = 0; j < mine.size(); j++)
+            {
+                bool found = false;
+
+                for (int k = 0; k < theirs.size() && !found; k++)
+                {
+                    const Area& a = *mine[j];
+                    const Area& b = *theirs[k];
+
+                    if (a.size() != b.size())
+                        continue;
+
+                    // An area is a circuit, so it's the same if it has the
+                    // same lines regardless of where it starts
+                    found = true;
+
+                    for (int l = 0; l < a.size() && found; l++)
+                    {
+                        found = false;
+
+                        for (int m = 0; m < b.size() && !found; m++)
+                            if (*a[l]->line == *b[m]->line)
+                                found = true;
+                    }
+                }
+
+                if (!found)
+                    return false;
+            }
+        }
+    }
+
+    return true;
 }
 
 /*
@@ -196,6 +638,10 @@ void Game::updateAreas()
  */
 bool Game::isInArea(const Area& target, Coord position) const    //Blame Luke for any problems here
 {
+    // Areas we find have an index so this doesn't have to look at every line
+    if (target.indexed())
+        return target.contains(position);
+
     int tSize = target.size(), lCount = 0, lSize = 0;
 
     for(int i=0;i<tSize;i++)
@@ -254,28 +700,279 @@ bool Game::connectable(const Node& nodea, const Node& nodeb) const
            nodea.areasets[1] == nodeb.areasets[1];
 }
 
+bool Game::canConnect(int a, int b) const
+{
+    if (!updated)
+        throw AreasOutdated();
+
+    return (partnerRows[a][b/wordBits] >> (b%wordBits)) & 1;
+}
+
+const Segments& Game::segments() const
+{
+    if (segmentsAt != changes)
+    {
+        lineSegments.clear();
+
+        for (int i = 0; i < lines.size(); i++)
+            lineSegments.add(*lines[i]);
+
+        segmentsAt = changes;
+    }
+
+    return lineSegments;
+}
+
+const NodeGrid& Game::nodeIndex() const
+{
+    if (!nodesIndexed)
+    {
+        nodeGrid.clear();
+
+        for (int i = 0; i < nodes.size(); i++)
+            nodeGrid.add(nodes[i]->getLoci());
+
+        nodesIndexed = true;
+    }
+
+    return nodeGrid;
+}
+
+int Game::nodeAt(Coord point, int* count) const
+{
+    int found = -1;
+    int same = 0;
+
+    if (nodesIndexed || ++nodeLookups > indexAfter)
+        return nodeIndex().find(point, count);
+
+    for (int i = 0; i < nodes.size(); i++)
+    {
+        if (nodes[i]->getLoci() == point)
+        {
+            if (found == -1)
+                found = i;
+
+            ++same;
+        }
+    }
+
+    if (count)
+        *count = same;
+
+    return found;
+}
+
+vector<int> Game::connectablePartners(const Node& node) const
+{
+    if (!updated)
+        throw AreasOutdated();
+
+    const int i = find(nodes.begin(), nodes.end(), &node) - nodes.begin();
+    vector<int> found;
+
+    for (int j = 0; j < nodes.size(); j++)
+        if (canConnect(i, j))
+            found.push_back(j);
+
+    return found;
+}
+
+bool Game::anyMovesLeft() const
+{
+    if (!updated)
+        throw AreasOutdated();
+
+    for (int i = 0; i < partnerRows.size(); i++)
+        for (int w = 0; w < partnerRows[i].size(); w++)
+            if (partnerRows[i][w])
+                return true;
+
+    return false;
+}
+
+void Game::resizePartners()
+{
+    const int words = (nodes.size() + wordBits-1)/wordBits;
+    const NodeLives none = { { NULL, NULL }, 0 };
+
+    // Nodes removed by undoMove() don't have any lives anymore
+    for (int i = nodes.size(); i < counted.size(); i++)
+        countLives(i, -1);
+
+    counted.resize(nodes.size(), none);
+
+    partnerRows.resize(nodes.size());
+
+    for (int i = 0; i < partnerRows.size(); i++)
+    {
+        partnerRows[i].resize(words, 0);
+
+        // Clear the bits of any nodes that were removed
+        if (nodes.size()%wordBits != 0)
+            partnerRows[i].back() &= (1UL << nodes.size()%wordBits) - 1;
+    }
+}
+
+void Game::refreshPartners()
+{
+    // The nodes on each areaset, so a node's row is the nodes on either of
+    // its areasets
+    map<Areaset*, vector<unsigned long> > on;
+    const int words = (nodes.size() + wordBits-1)/wordBits;
+
+    for (int i = 0; i < nodes.size(); i++)
+    {
+        if (nodes[i]->dead())
+            continue;
+
+        for (int side = 0; side < 2; side++)
+        {
+            vector<unsigned long>& mask = on[nodes[i]->areasets[side]];
+
+            mask.resize(words, 0);
+            mask[i/wordBits] |= 1UL << (i%wordBits);
+        }
+    }
+
+    partnerRows.assign(nodes.size(), vector<unsigned long>(words, 0));
+
+    for (int i = 0; i < nodes.size(); i++)
+    {
+        vector<unsigned long>& row = partnerRows[i];
+
+        if (!nodes[i]->dead())
+        {
+            const vector<unsigned long>& first = on[nodes[i]->areasets[0]];
+            const vector<unsigned long>& second = on[nodes[i]->areasets[1]];
+
+            for (int w = 0; w < words; w++)
+                row[w] = first[w] | second[w];
+        }
+
+        // Itself is only for a loop, which doesn't depend on the areas
+        if (connectable(*nodes[i], *nodes[i]))
+            row[i/wordBits] |= 1UL << (i%wordBits);
+        else
+            row[i/wordBits] &= ~(1UL << (i%wordBits));
+    }
+
+    regionLives.clear();
+    counted.clear();
+    movableRegions = 0;
+    resizePartners();
+
+    for (int i = 0; i < nodes.size(); i++)
+        recountLives(i);
+}
+
+void Game::refreshPartners(const vector<Node*>& changed)
+{
+    resizePartners();
+
+    for (int c = 0; c < changed.size(); c++)
+    {
+        const int i = find(nodes.begin(), nodes.end(), changed[c]) - nodes.begin();
+
+        // Removed by undoMove()
+        if (i == nodes.size())
+            continue;
+
+        recountLives(i);
+
+        for (int j = 0; j < nodes.size(); j++)
+        {
+            const unsigned long bitJ = 1UL << (j%wordBits);
+            const unsigned long bitI = 1UL << (i%wordBits);
+
+            if (connectable(*nodes[i], *nodes[j]))
+            {
+                partnerRows[i][j/wordBits] |= bitJ;
+                partnerRows[j][i/wordBits] |= bitI;
+            }
+            else
+            {
+                partnerRows[i][j/wordBits] &= ~bitJ;
+                partnerRows[j][i/wordBits] &= ~bitI;
+            }
+        }
+    }
+}
+
+void Game::countLives(int node, int sign)
+{
+    const NodeLives& c = counted[node];
+
+    for (int side = 0; side < 2 && c.lives > 0; side++)
+    {
+        if (side == 1 && c.sets[1] == c.sets[0])
+            break;
+
+        int& lives = regionLives[c.sets[side]];
+        const bool movable = lives >= 2;
+
+        lives += sign*c.lives;
+        movableRegions += (lives >= 2) - movable;
+
+        if (lives == 0)
+            regionLives.erase(c.sets[side]);
+    }
+}
+
+void Game::recountLives(int node)
+{
+    const Node& n = *nodes[node];
+
+    countLives(node, -1);
+
+    counted[node].sets[0] = n.areasets[0];
+    counted[node].sets[1] = n.areasets[1];
+    counted[node].lives = 3 - n.conCount();
+
+    countLives(node, 1);
+}
+
 Node& Game::insertNode(Coord coord, Connection con1, Connection con2)
 {
     // We've changed something, must update after this
     updated = false;
+    ++changes;
 
     Node* node = new Node(coord, con1, con2);
     nodes.push_back(node);
+
+    if (nodesIndexed)
+        nodeGrid.add(coord);
+
     return *node;
 }
 
 Line& Game::insertLine(const Line& line)
 {
-        // We've changed something, must update after this
+    // We've changed something, must update after this
     updated = false;
 
+    // Add it to the segments if they were up to date, which is a lot faster
+    // than finding them all again later
+    const bool current = (segmentsAt == changes);
+    ++changes;
+
     Line* keep = new Line(line);
     lines.push_back(keep);
+
+    if (current)
+    {
+        lineSegments.add(line);
+        segmentsAt = changes;
+    }
+
     return *keep;
 }
 
 void Game::clearAreas()
 {
+    forgetAreaChanges();
+
     for (int i = 0; i < areas.size(); ++i)
         delete areas[i];
 
@@ -286,11 +983,17 @@ void Game::clearAreas()
     // Just to make sure we never try accessing those again
     areas.clear();
     areasets.clear();
+    uniqueAreas.clear();
+    uniqueAreasets.clear();
+    regionLives.clear();
+    counted.clear();
+    movableRegions = 0;
 }
 
 void Game::cleanup()
 {
     clearAreas();
+    history.clear();
 
     for (int i = 0; i < nodes.size(); ++i)
         delete nodes[i];
@@ -344,60 +1047,38 @@ ostream& operator<<(ostream& os, const Game& g)
     return os;
 }
 
-void Game::doMove(const Line& line, Coord middle, bool extraChecks)
+MoveCheck Game::planMove(const Line& line, Coord middle, PlannedMove& plan, bool connect) const
 {
-    updated = false;
+    int same = 0;
 
-    // Determine the end nodes
-    Node* a = NULL;
-    Node* b = NULL;
+    if (line.size() == 0)
+        return MoveInvalidLine;
 
-    for (int i = 0; i < nodes.size(); i++)
-    {
-        if (nodes[i]->getLoci() == line.front())
-        {
-            if (a)
-                throw InvalidNode();
-            else
-                a = nodes[i];
-        }
+    // Determine the end nodes, which have to be the only ones there
+    const int ai = nodeAt(line.front(), &same);
 
-        if (nodes[i]->getLoci() == line.back())
-        {
-            if (b)
-                throw InvalidNode();
-            else
-                b = nodes[i];
-        }
-    }
+    if (same != 1)
+        return MoveInvalidNode;
 
-    // Couldn't find nodes
-    if (!a || !b)
-        throw InvalidNode();
+    const int bi = nodeAt(line.back(), &same);
 
-    if (line.size() == 0)
-        throw InvalidLine(line);
+    if (same != 1)
+        return MoveInvalidNode;
 
-    // Now that line crossings work, we don't really need to do this. In games
-    // with 10 nodes or so, it starts taking a while. We'll specify when
-    // creating the game whether we want extra checks (like this) to be
-    // performed.
-    if (extraChecks)
-    {
-        updateAreas();
+    plan.a = nodes[ai];
+    plan.b = nodes[bi];
 
-        if (!connectable(*a, *b))
-            throw NotConnectable();
-    }
+    if (connect && !canConnect(ai, bi))
+        return MoveNotConnectable;
 
     // Split the line using the middle coordinate
-    int count = 0; // Add to first line when 0, second when 1
-    Line AC_line;
-    Line CB_line;
+    plan.count = 0; // Add to first line when 0, second when 1
+    plan.ac.clear();
+    plan.cb.clear();
 
     // First point since we start at the second point, looking at the first
     // line segment
-    AC_line.push_back(line.front());
+    plan.ac.push_back(line.front());
 
     // When between two points, split there
     for (int i = 1; i < line.size(); i++)
@@ -409,43 +1090,135 @@ void Game::doMove(const Line& line, Coord middle, bool extraChecks)
                 ((middle.y > line[i].y && middle.y < line[i-1].y)   ||
                  (middle.y < line[i].y && middle.y > line[i-1].y))))
         {
-            ++count;
-            AC_line.push_back(middle);
-            CB_line.push_back(middle);
-            CB_line.push_back(line[i]);
+            ++plan.count;
+            plan.ac.push_back(middle);
+            plan.cb.push_back(middle);
+            plan.cb.push_back(line[i]);
         }
         else
         {
-            if (count == 0)
-                AC_line.push_back(line[i]);
+            if (plan.count == 0)
+                plan.ac.push_back(line[i]);
             else
-                CB_line.push_back(line[i]);
+                plan.cb.push_back(line[i]);
         }
     }
 
     // We should have found a place to put the middle point
-    if (count != 1)
-        throw InvalidMiddle(count, middle);
+    if (plan.count != 1)
+        return MoveInvalidMiddle;
+
+    // Note that if the middle point is on a corner, it won't be found above
+    // because we check that x or y is less than one and greater than the
+    // other, meaning that it can't be equal to either. So the middle node
+    // always has its lines coming in straight from opposite sides, but the
+    // ends have to have room for them.
+    Node::Entry entry;
+
+    if (plan.a == plan.b)
+        entry = plan.a->checkEntry(&plan.ac, &plan.cb);
+    else if ((entry = plan.a->checkEntry(&plan.ac)) == Node::EntryOK)
+        entry = plan.b->checkEntry(&plan.cb);
+
+    switch (entry)
+    {
+        case Node::EntryFull:      return MoveNotConnectable;
+        case Node::EntryBadLine:   return MoveInvalidLine;
+        case Node::EntryCollision: return MoveEntryCollision;
+        case Node::EntryCorner:    return MoveInvalidCorner;
+        default:                   return MoveOK;
+    }
+}
+
+MoveCheck Game::checkMove(const Line& line, Coord middle) const
+{
+    const MoveCheck result = planMove(line, middle, checked, updated);
+
+    if (result == MoveOK)
+    {
+        checked.line = line;
+        checked.middle = middle;
+        checkedAt = changes;
+    }
+    else
+    {
+        checkedAt = -1;
+    }
+
+    return result;
+}
 
-    // Note that if the middle point is on a corner, it will throw above because
-    // we check that x or y is less than one and greater than the other, meaning
-    // that it can't be equal to either.
+void Game::doMove(const Line& line, Coord middle, bool extraChecks)
+{
+    // If the areas are up to date, we only have to update the region this
+    // line goes through instead of rebuilding all of them
+    bool split = incremental && updated;
+    vector<Areaset*> shared;
+    Node* c = NULL;
+    PlannedMove planned;
+    const PlannedMove* plan = &planned;
+
+    // Skip checking it again if checkMove() just did
+    if (checkedAt == changes && checked.line == line && checked.middle == middle)
+    {
+        plan = &checked;
+    }
+    else
+    {
+        switch (planMove(line, middle, planned, false))
+        {
+            case MoveInvalidNode:    throw InvalidNode();
+            case MoveInvalidLine:    throw InvalidLine(line);
+            case MoveInvalidMiddle:  throw InvalidMiddle(planned.count, middle);
+            case MoveNotConnectable: throw NotConnectable();
+            case MoveEntryCollision: throw NodeEntryCollision();
+            case MoveInvalidCorner:  throw InvalidCorner();
+            default:                 break;
+        }
+    }
 
-    Line& AC = insertLine(AC_line);
-    Line& CB = insertLine(CB_line);
+    Node* a = plan->a;
+    Node* b = plan->b;
+
+    // Now that line crossings work, we don't really need to do this. In games
+    // with 10 nodes or so, it starts taking a while. We'll specify when
+    // creating the game whether we want extra checks (like this) to be
+    // performed.
+    if (extraChecks)
+    {
+        updateAreas();
+
+        if (!connectable(*a, *b))
+            throw NotConnectable();
+
+        split = incremental;
+    }
+
+    updated = false;
+
+    // The region(s) the line goes through, the ones both nodes are in
+    if (split)
+        for (int i = 0; i < 2; i++)
+            for (int j = 0; j < 2; j++)
+                if (a->areasets[i] && a->areasets[i] == b->areasets[j] &&
+                    find(shared.begin(), shared.end(), a->areasets[i]) == shared.end())
+                    shared.push_back(a->areasets[i]);
+
+    Line& AC = insertLine(plan->ac);
+    Line& CB = insertLine(plan->cb);
 
     try
     {
         // Insert middle node C between nodes A and B
-        Node& c = insertNode(middle,
+        c = &insertNode(middle,
                 Connection(&AC, a),
                 Connection(&CB, b));
         try
         {
 
             // Likewise add the connection to the start and end nodes
-            a->addConnection(Connection(&AC, &c));
-            b->addConnection(Connection(&CB, &c));
+            a->addConnection(Connection(&AC, c));
+            b->addConnection(Connection(&CB, c));
 
             ++moveCount;
         }
@@ -465,10 +1238,67 @@ void Game::doMove(const Line& line, Coord middle, bool extraChecks)
         delete &CB;
         lines.pop_back();
         lines.pop_back();
+        ++changes;
         throw;
     }
 
-    updateAreas();
+    history.push_back(MoveRecord(c));
+
+    // If they weren't in the same region, something's wrong, so just
+    // recompute everything
+    if (!shared.empty())
+    {
+        splitAreas(*c, shared, history.back());
+
+        if (verify)
+        {
+            Game full(*this);
+            full.updateAreas();
+
+            if (!sameAreas(full))
+                throw AreasMismatch();
+        }
+    }
+    else
+    {
+        updateAreas();
+    }
+}
+
+void Game::undoMove()
+{
+    if (history.empty())
+        throw NoMoveToUndo();
+
+    MoveRecord& record = history.back();
+    bool restore = record.saved && updated;
+    vector<Node*> changed;
+
+    if (restore)
+    {
+        for (int i = 0; i < record.nodeSets.size(); i++)
+            changed.push_back(record.nodeSets[i].node);
+
+        restoreAreas(record);
+    }
+
+    // Remove the middle node, which also takes its connections off the two
+    // ends, and then the lines
+    deleteLastNode();
+
+    for (int i = 0; i < 2; i++)
+    {
+        delete lines.back();
+        lines.pop_back();
+    }
+
+    --moveCount;
+    history.pop_back();
+
+    if (restore)
+        refreshPartners(changed);
+    else
+        updateAreas();
 }
 
 int Game::moves() const
@@ -478,24 +1308,20 @@ int Game::moves() const
 
 bool Game::gameEnded() const
 {
-    // Loop through all nodes and return true if none of them can be connected
-    for (int i = 0; i < nodes.size(); i++)
-    {
-        for (int j = i; j < nodes.size(); j++)
-        {
-            if (connectable(*nodes[i], *nodes[j]))
-            {
-                return false;
-            }
-        }
-    }
+    if (!updated)
+        throw AreasOutdated();
 
-    return true;
+    // A region with two lives either has two live nodes, which can be
+    // connected, or one with room for a loop
+    return movableRegions == 0;
 }
 
 void Game::deleteLastNode()
 {
     Node& node = *nodes.back();
+    vector<Node*> others;
+
+    ++changes;
 
     for (int i = 0; i < 3; i++)
     {
@@ -509,7 +1335,7 @@ void Game::deleteLastNode()
                 if (otherNode.connections[j].dest == &node)
                 {
                     otherNode.connections[j] = Connection();
-                    otherNode.updateOpen();
+                    others.push_back(&otherNode);
                     break;
                 }
             }
@@ -518,17 +1344,23 @@ void Game::deleteLastNode()
         }
     }
 
+    // Only once they're all gone, since for a loop that doMove() is backing
+    // out of, the other end might not be valid until both are removed
+    for (int i = 0; i < others.size(); i++)
+        others[i]->updateOpen();
+
     delete nodes.back();
     nodes.pop_back();
+
+    if (nodesIndexed)
+        nodeGrid.removeLast();
 }
 
 Node* Game::findNode(Coord point) const
 {
-    for (int i = 0; i < nodes.size(); i++)
-        if (nodes[i]->getLoci() == point)
-            return nodes[i];
+    const int found = nodeAt(point);
 
-    return NULL;
+    return (found != -1)?nodes[found]:NULL;
 }
 
 
@@ -4,7 +4,13 @@
 #include "headers/gameai.h"
 
 GameAI::GameAI()
-    :Game(), startingNodes(-1)
+    :Game(), startingNodes(-1), printSearch(true)
+{
+
+}
+
+GameAI::GameAI(const GameState& s)
+    :Game(s), startingNodes(-1), printSearch(true)
 {
 
 }
@@ -12,87 +18,104 @@ GameAI::GameAI()
 
 bool GameAI::aiTurn()
 {
-    // Johnathan's original dummy game code
-    /*vector<int> mValues;
-    //Game& cGame= *this;
-    Game* tGame = new Game(static_cast<Game>(*this));
-    populateMList(); //will populate the possibleMoves vector
-    populatemTable();
-    //insert the move into the temp game
-    tGame->insertNode(new Node());
-    for(int i=0;i <mTable.size();i++)
+    const Position p(state());
+    const vector<AbstractMove> moves = solver.rank(p);
+
+    if (printSearch)
+        cout << "AI: " << solver << endl;
+
+    // While it's winning, draw any move that leaves the same position as the
+    // best one, and if there isn't room for any of them, look for the best of
+    // the rest, since another move may win too
+    const vector<AbstractMove> all = p.moves();
+    vector<AbstractMove> best = moves;
+    set<string> undrawable;
+
+    while (!best.empty() && solver.value() == 1)
     {
-        int sum=0;
-        for(int j=0;j<mTable[i].size();j++)
+        const string key = p.play(best.front()).key();
+
+        for (int i = 0; i < all.size(); i++)
         {
-            sum+=(int)(mTable[i][j]);
+            if (p.play(all[i]).key() != key)
+                continue;
+
+            try
+            {
+                Coord middle;
+                Line line = findLine(all[i], middle);
+
+                doMove(line, middle);
+                return true;
+            }
+            catch (const NoLineFound&)
+            {
+
+            }
         }
-        mValues.push_back(sum);
-    }
-    int n=max_element(mValues.begin(),mValues.end());
-    //n=mValue.begin();
 
-    delete tGame;*/
+        undrawable.insert(key);
+        best = solver.rank(p, undrawable);
+    }
 
-    // Set start nodes and aiFirst on first AI turn
-    /*if(startingNodes == -1)
+    // Otherwise skip moves there isn't room to draw
+    for (int i = 0; i < moves.size(); i++)
     {
-        if(moves()%2) //Second player, one move has been made
+        try
         {
-            aiFirst = true;
-            startingNodes = nodes.size()  - 1;
+            Coord middle;
+            Line line = findLine(moves[i], middle);
+
+            doMove(line, middle);
+            return true;
         }
-        else // First player, no moves have been made yet
+        catch (const NoLineFound&)
         {
-            aiFirst = false;
-            startingNodes = nodes.size();
+
         }
     }
 
-    //Finds whether we want an even or odd number of areas
-    //Moves%2 returns true if the ai is second player
-    wantedAreas = requiredAreas(aiFirst ,startingNodes);
-    populateMList();
-
-    for(int i = 0; i < possibleMoves.size(); i++)
+    // Then any line between the nodes of a move even if it doesn't split the
+    // region the same way, since that's still a move
+    for (int i = 0; i < moves.size(); i++)
     {
-        // Create new dummy game. This is GameAI since we have to access data
-        // that only something inheriting from it can access.
-        GameAI* tGame = new GameAI(*this);
-
-        //insert the move into the temp game
-        tGame->doMove(possibleMoves[i], midNode(possibleMoves[i]));
-        testUnuseableNodes = tGame->notConnectableNodes();
-
-        delete tGame;
-
-        if (testUnuseableNodes%2 == wantedAreas)
+        try
         {
-            doMove(possibleMoves[i], midNode(possibleMoves[i]));
+            Coord middle;
+            Line line = findLine(moves[i], middle, false);
+
+            doMove(line, middle);
             return true;
         }
-    }*/
-    //If an optimal move is not found, it does the first move in the possible moves vector
+        catch (const NoLineFound&)
+        {
+
+        }
+    }
+
+    // If none of those worked, it does the first move in the possible moves vector
     populateMList();
 
     for (int i = 0; i < possibleMoves.size(); i++)
     {
-        try
+        const Coord middle = midNode(possibleMoves[i]);
+
+        if (checkMove(possibleMoves[i], middle) == MoveOK)
         {
-            //cout << possibleMoves[i] << endl;
-            //cout << midNode(possibleMoves[i]) << endl;
-            doMove(possibleMoves[i], midNode(possibleMoves[i]));
+            doMove(possibleMoves[i], middle);
             return true;
         }
-        catch (...)
-        {
-
-        }
     }
 
     return false;
 }
 
+void GameAI::setThinking(int milliseconds, bool print)
+{
+    solver = Solver(milliseconds);
+    printSearch = print;
+}
+
 bool GameAI::requiredAreas(bool player, int startingNodes) const
 {
     //This method determines what number of nodes the ai requires to win
@@ -127,7 +150,7 @@ void GameAI::populateMList()
     {
         for (int j = i+1; j < nodes.size()-1; j++)
         {
-            if(connectable(*nodes[i],*nodes[j]))
+            if(canConnect(i,j))
             {
                 if(validLine(nodes[i]->getLoci(),nodes[j]->getLoci(),true) || validLine(nodes[i]->getLoci(),nodes[j]->getLoci(),false))
                 {
@@ -149,7 +172,7 @@ int GameAI::notConnectableNodes() const
     {
         for (int j = i+1; j < nodes.size(); j++)
         {
-            if (!connectable(*nodes[i], *nodes[j]) && !nodes[i]->dead() && !nodes[j]->dead())
+            if (!canConnect(i, j) && !nodes[i]->dead() && !nodes[j]->dead())
             {
                 n.push_back(i);
                 break;
@@ -176,7 +199,7 @@ int GameAI::notConnectableNodes() const
     {
         for (int j = i+1; j < n.size(); j++)
         {
-            if (connectable(*nodes[n[i]], *nodes[n[j]]))
+            if (canConnect(n[i], n[j]))
             {
                 count[i]++;
             }
@@ -336,231 +359,772 @@ Line GameAI::createLine(Node* a, Node* b) const
     return line;
 }
 
-Coord GameAI::midNode(const Line& currentLine) const
+// Which way to go on the grid for each side of a node, like Node::Dir
+static const int stepX[4] = { 0, 1, 0, -1 };
+static const int stepY[4] = { -1, 0, 1, 0 };
+
+// Whether a new line can come out of this side of the node, optionally after
+// another new line is already on the taken side. If the node will have two
+// lines, they have to be straight across from each other.
+static bool canLeave(const Node& node, int side, int taken = -1)
 {
-    int longestIndex = -1;
-    double greatestDist = 0;
+    bool open[4] = { node.openUp(), node.openRight(), node.openDown(), node.openLeft() };
+    int count = node.conCount();
 
-    for (int i = 1; i < currentLine.size(); i++)
+    if (taken != -1)
     {
-        double currentDist = distance(currentLine[i], currentLine[i-1]);
+        open[taken] = false;
+        ++count;
+    }
 
-        if (currentDist > greatestDist)
+    if (!open[side])
+        return false;
+
+    if (count == 1)
+        return !open[(side+2)%4];
+
+    return true;
+}
+
+// Sort the coordinates and add ones past both ends, then split each gap into
+// parts. Game::sidePoint() looks one pixel to each side of a node, so new ones
+// have to be at least two away from everything else.
+static vector<int> spread(vector<int> values, int margin, int parts)
+{
+    vector<int> result;
+
+    sort(values.begin(), values.end());
+    values.erase(unique(values.begin(), values.end()), values.end());
+    values.insert(values.begin(), values.front() - margin);
+    values.push_back(values.back() + margin);
+
+    for (int i = 0; i < values.size(); i++)
+    {
+        if (i > 0)
         {
-            greatestDist = currentDist;
-            longestIndex = i;
+            const int gap = values[i] - values[i-1];
+            const int split = min(parts, gap/2);
+
+            for (int j = 1; j < split; j++)
+                result.push_back(values[i-1] + gap*j/split);
         }
+
+        result.push_back(values[i]);
     }
 
-    // Something went wrong, just pick the middle
-    if (longestIndex == -1)
-        longestIndex = currentLine.size()/2;
+    return result;
+}
 
-    return Coord((currentLine[longestIndex-1].x+currentLine[longestIndex].x)/2,
-                 (currentLine[longestIndex-1].y+currentLine[longestIndex].y)/2);
+static int column(const vector<int>& values, int value)
+{
+    return lower_bound(values.begin(), values.end(), value) - values.begin();
+}
+
+// Which of the points are below a step on the grid, each one a bit. Looking
+// up from just to the right of each point, the new line and the boundary it
+// splits cross that an odd number of times if the point ends up inside.
+static int crossed(const vector<Coord>& points, int x1, int x2, int y)
+{
+    int bits = 0;
+
+    for (int i = 0; i < points.size(); i++)
+        if (y < points[i].y && min(x1, x2) <= points[i].x && points[i].x < max(x1, x2))
+            bits |= 1 << i;
+
+    return bits;
+}
+
+// Halfway between two values, moved to one already on the grid if there's one
+// between them so that the new node isn't right next to another line
+static int middleOf(const vector<int>& values, int a, int b)
+{
+    const int middle = (a + b)/2;
+    const int low = column(values, min(a, b) + 1);
+    const int high = column(values, max(a, b)) - 1;
+
+    if (low > high)
+        return middle;
+
+    int best = low;
+
+    for (int i = low + 1; i <= high; i++)
+        if (abs(values[i] - middle) < abs(values[best] - middle))
+            best = i;
+
+    return values[best];
+}
+
+// Remove the points in the middle of straight parts of the line
+static Line straighten(const Line& line)
+{
+    Line result(1, line.front());
+
+    for (int i = 1; i < line.size()-1; i++)
+    {
+        const Coord& a = result.back();
+        const Coord& b = line[i];
+        const Coord& c = line[i+1];
+
+        if ((a.x == b.x && b.x == c.x) || (a.y == b.y && b.y == c.y))
+            continue;
 
+        result.push_back(b);
+    }
+
+    result.push_back(line.back());
+
+    return result;
 }
 
-bool GameAI::validSingleLine(const Line& line, Coord start, Coord end) const
+// The grid searched by findLine(). A state is a point on the grid and which of
+// the points being kept track of the line has gone over so far.
+struct RouteGrid
 {
-    const int startX = start.x;
-    const int startY = start.y;
-    const int endX = end.x;
-    const int endY = end.y;
+    vector<int> xs;
+    vector<int> ys;
+    vector<bool> blocked;
+    vector<int> clearance; // Pixels to the nearest blocked point, across or down
+                           // whichever is farther
+    vector<Coord> others;
+    int w;
+    int h;
+    int groups;
+    int crowded;
+    int room; // Clearance wanted around new lines
+    int ends[2]; // Cells of the nodes being joined
 
-    for (int j = 1; j < line.size(); j++)
+    // Set the clearance of each point after blocking what's drawn. First the
+    // distance across each row, then the nearest of those up and down each
+    // column.
+    void measure()
     {
-        const int A2 = line[j-1].x;
-        const int B2 = line[j-1].y;
-        const int A3 = line[j].x;
-        const int B3 = line[j].y;
+        vector<int> across(w*h, room);
 
-        if (endX == startX)
+        for (int y = 0; y < h; y++)
         {
-            if(A2 != A3)
+            for (int pass = 0; pass < 2; pass++)
             {
-                if(A2 > A3)
+                int last = -1;
+
+                for (int j = 0; j < w; j++)
                 {
-                    if((startX > A3)&&(startX < A2))
-                    {
-                        if(startY > endY)
-                        {
-                            if((B2 < startY)&&(B2 > endY))
-                                return false;
-                        }
-                        else
-                            if((B2 > startY)&&(B2 < endY))
-                                return false;
-                    }
+                    const int x = pass?w-1-j:j;
+                    const int c = y*w + x;
+
+                    if (blocked[c])
+                        last = xs[x];
+
+                    if (last != -1)
+                        across[c] = min(across[c], abs(xs[x] - last));
                 }
-                else
-                    if((startX < A3)&&(startX > A2))
-                    {
-                        if(startY > endY)
-                        {
-                            if((B2 < startY)&&(B2 > endY))
-                                return false;
-                        }
-                        else
-                            if((B2 > startY)&&(B2 < endY))
-                                return false;
-                    }
             }
-            else
-                if(startX == A2)
-                {
-                    if(B2 > B3)
-                    {
-                        if(((startY > B3)&&(startY <B2))||((endY > B3)&&(endY < B2)))
-                            return false;
-                        if(startY < endY)
-                        {
-                            if((startY < B3)&&(endY > B3))
-                                return false;
-                        }
-                        else
-                            if((startY > B2)&&(endY < B2))
-                                return false;
-                    }
-                    else
-                    {
-                        if(((startY > B2)&&(startY < B3))||((endY > B2)&&(endY < B3)))
-                            return false;
-                        if(startY < endY)
-                        {
-                            if((startY < B2)&&(endY > B2))
-                                return false;
-                        }
-                        else
-                            if((startY > B3)&&(endY < B3))
-                                return false;
-                    }
-                }
+        }
+
+        clearance.assign(w*h, room);
+
+        for (int c = 0; c < w*h; c++)
+        {
+            const int x = c%w;
+            const int y = c/w;
+            int& near = clearance[c];
+
+            for (int other = y; other >= 0 && ys[y] - ys[other] < near; other--)
+                near = min(near, max(across[other*w + x], ys[y] - ys[other]));
 
+            for (int other = y + 1; other < h && ys[other] - ys[y] < near; other++)
+                near = min(near, max(across[other*w + x], ys[other] - ys[y]));
         }
-        else
+    }
+
+    int cell(int state) const { return state/groups; }
+
+    // Whether a line can go through a point. Game::sidePoint() looks one pixel
+    // to each side of a node, so it can't be right next to anything else
+    // either, except a pixel away from the nodes it's joining.
+    bool open(int c) const
+    {
+        if (blocked[c])
+            return false;
+
+        if (clearance[c] >= 2)
+            return true;
+
+        for (int i = 0; i < 2; i++)
+            if (abs(xs[c%w] - xs[ends[i]%w]) + abs(ys[c/w] - ys[ends[i]/w]) == 1)
+                return true;
+
+        return false;
+    }
+
+    // The state after going from this one in dir, or -1 if we can't
+    int step(int state, int dir) const
+    {
+        const int x = cell(state)%w;
+        const int y = cell(state)/w;
+        const int nx = x + stepX[dir];
+        const int ny = y + stepY[dir];
+
+        if (nx < 0 || nx >= w || ny < 0 || ny >= h || !open(ny*w + nx))
+            return -1;
+
+        return (ny*w + nx)*groups + ((state%groups) ^ crossed(others, xs[x], xs[nx], ys[y]));
+    }
+
+    // How long a step into a cell is. Going close to something already drawn
+    // costs more so there's still room around the line for later moves.
+    int cost(int from, int to) const
+    {
+        const int x = cell(to)%w;
+        const int y = cell(to)/w;
+        const int length = abs(xs[x] - xs[cell(from)%w]) + abs(ys[y] - ys[cell(from)/w]);
+        const int missing = room - clearance[cell(to)];
+
+        // Right up against something a step counts as up to this many times
+        // as long
+        const int squeeze = 10;
+
+        return length + (length*(squeeze - 1) + crowded)*missing*missing/(room*room);
+    }
+
+    // Shortest paths from a state, setting the state each one was reached from
+    // and how far away it is
+    void search(int start, vector<int>& from, vector<int>& distance) const
+    {
+        priority_queue<pair<int, int>, vector<pair<int, int> >, greater<pair<int, int> > > todo;
+
+        from.assign(w*h*groups, -2);
+        distance.assign(w*h*groups, -1);
+        from[start] = -1;
+        distance[start] = 0;
+        todo.push(make_pair(0, start));
+
+        while (!todo.empty())
         {
-            if(B2 != B3)
+            const int d = todo.top().first;
+            const int at = todo.top().second;
+            todo.pop();
+
+            if (d > distance[at])
+                continue;
+
+            for (int dir = 0; dir < 4; dir++)
             {
-                if(B2 > B3)
+                const int state = step(at, dir);
+
+                if (state == -1)
+                    continue;
+
+                const int length = d + cost(at, state);
+
+                if (distance[state] == -1 || length < distance[state])
                 {
-                    if((startY < B2)&&(startY > B3))
-                    {
-                        if(startX > endX)
-                        {
-                            if((A2 < startX)&&(A2 > endX))
-                                return false;
-                        }
-                        else
-                            if((A2 > startX)&&(A2 < endX))
-                                return false;
-                    }
+                    from[state] = at;
+                    distance[state] = length;
+                    todo.push(make_pair(length, state));
                 }
-                else
-                    if((startY > B2)&&(startY < B3))
-                    {
-                        if(startX > endX)
-                        {
-                            if((A2 < startX)&&(A2 > endX))
-                                return false;
-                        }
-                        else
-                            if((A2 > startX)&&(A2 < endX))
-                                return false;
-                    }
             }
-            else
-                if(startY == B2)
+        }
+    }
+
+    // Where a way first comes back to a point it already went through, the
+    // index of the last point before that or the end if it never does
+    int turnsAround(const vector<int>& way) const
+    {
+        set<int> cells;
+
+        for (int i = 0; i < way.size(); i++)
+            if (!cells.insert(cell(way[i])).second)
+                return i-1;
+
+        return way.size()-1;
+    }
+
+    // The same way but going around the part from the first point it comes
+    // back to until the last time it's there the other way, which goes over
+    // the same steps and so around the same points
+    vector<int> flipped(const vector<int>& way) const
+    {
+        int first = -1;
+        int last = -1;
+
+        for (int i = 0; i < way.size() && first == -1; i++)
+            for (int j = way.size()-1; j > i && first == -1; j--)
+                if (cell(way[i]) == cell(way[j]))
                 {
-                    if(A2 > A3)
-                    {
-                        if(((startX > A3)&&(startX < A2))||((endX > A3)&&(endX < A2)))
-                            return false;
-                        if(startX < endX)
-                        {
-                            if((startX < A3)&&(endX > A3))
-                                return false;
-                        }
-                        else
-                            if((startX > A2)&&(endX < A2))
-                                return false;
-                    }
-                    else
-                    {
-                        if(((startX > A2)&&(startX < A3))||((endX > A2)&&(endX < A3)))
-                            return false;
-                        if(startX < endX)
-                        {
-                            if((startX < A2)&&(endX > A2))
-                                return false;
-                        }
-                        else
-                            if((startX > A3)&&(endX < A3))
-                                return false;
-                    }
+                    first = i;
+                    last = j;
                 }
+
+        if (first == -1)
+            return way;
+
+        vector<int> cells;
+
+        for (int i = 0; i < way.size(); i++)
+            cells.push_back(cell(way[i]));
+
+        reverse(cells.begin() + first, cells.begin() + last + 1);
+
+        // Take the same steps between the points again to know what's been
+        // gone around on the way
+        vector<int> result(1, way.front());
+
+        for (int i = 1; i < cells.size(); i++)
+            for (int dir = 0; dir < 4; dir++)
+                if (step(result.back(), dir) != -1 && cell(step(result.back(), dir)) == cells[i])
+                {
+                    result.push_back(step(result.back(), dir));
+                    break;
+                }
+
+        return result;
+    }
+
+    // The shortest way usually only goes back over itself to get around
+    // something and come back. Follow it to where it turns around and look
+    // for the rest of the way from there without going through any of the
+    // points used so far, doing that again if the rest turns around too.
+    // Which side of the first part the rest ends up on depends on which way
+    // it went around where it turned, so that can be flipped if there's no
+    // room on the one side.
+    bool untangle(int start, int goal, bool flip, vector<int>& path) const
+    {
+        RouteGrid rest(*this);
+        vector<int> from;
+        vector<int> distance;
+        int at = start;
+
+        path.assign(1, start);
+
+        for (int turns = 0; turns < 8; turns++)
+        {
+            rest.measure();
+            rest.search(at, from, distance);
+
+            if (from[goal] == -2)
+                return false;
+
+            vector<int> way;
+
+            for (int state = goal; state >= 0; state = from[state])
+                way.push_back(state);
+
+            reverse(way.begin(), way.end());
+
+            if (flip && turns == 0)
+                way = flipped(way);
+
+            const int last = turnsAround(way);
+
+            for (int i = 0; i <= last; i++)
+                rest.blocked[cell(way[i])] = true;
+
+            path.insert(path.end(), way.begin()+1, way.begin()+last+1);
+            at = way[last];
+
+            if (at == goal)
+                return true;
         }
+
+        return false;
     }
 
-    return true;
-}
+    // The shortest way doesn't know to keep away from itself, so a line going
+    // around something comes back right along where it went. Keep the first
+    // half and look for the rest again from there staying clear of it.
+    bool spaceOut(vector<int>& path) const
+    {
+        RouteGrid rest(*this);
+        vector<int> from;
+        vector<int> distance;
+        vector<int> along(1, 0);
 
-bool GameAI::validLine(Coord start, Coord end) const
-{
-    for (int i = 0; i < lines.size(); i++)
+        for (int i = 1; i < path.size(); i++)
+            along.push_back(along.back() + abs(xs[cell(path[i])%w] - xs[cell(path[i-1])%w]) +
+                abs(ys[cell(path[i])/w] - ys[cell(path[i-1])/w]));
+
+        const int half = lower_bound(along.begin(), along.end(), along.back()/2) - along.begin();
+
+        if (half == 0 || half == path.size()-1)
+            return false;
+
+        for (int i = 0; i <= half; i++)
+            rest.blocked[cell(path[i])] = true;
+
+        rest.measure();
+        rest.search(path[half], from, distance);
+
+        if (from[path.back()] == -2)
+            return false;
+
+        vector<int> way;
+
+        for (int state = path.back(); state != path[half]; state = from[state])
+            way.push_back(state);
+
+        if (turnsAround(way) != way.size()-1)
+            return false;
+
+        path.erase(path.begin()+half+1, path.end());
+        path.insert(path.end(), way.rbegin(), way.rend());
+
+        return true;
+    }
+
+    // The shortest way to the goal that doesn't go through any grid point
+    // twice. The shortest path may go back over itself to get around
+    // something, so if it does, untangle it, or if that doesn't work search
+    // depth first always heading closer to the goal if possible, giving up
+    // after trying so many points.
+    bool simplePath(int start, int goal, const vector<int>& from, vector<int>& path) const
     {
-        const Line& line = *lines[i];
+        vector<int> notUsed;
+        vector<int> toGoal;
 
-        if (!validSingleLine(line, start, end))
+        if (from[goal] == -2)
             return false;
+
+        path.clear();
+
+        for (int at = goal; at >= 0; at = from[at])
+            path.push_back(at);
+
+        reverse(path.begin(), path.end());
+
+        set<int> cells;
+
+        for (int i = 0; i < path.size(); i++)
+            cells.insert(cell(path[i]));
+
+        if (cells.size() == path.size())
+            return true;
+
+        // Going the other way it might turn around somewhere else
+        for (int flip = 0; flip < 2; flip++)
+        {
+            if (untangle(start, goal, flip, path))
+                return true;
+
+            if (untangle(goal, start, flip, path))
+            {
+                reverse(path.begin(), path.end());
+                return true;
+            }
+        }
+
+        search(goal, notUsed, toGoal);
+
+        // Each point on the way and the ones left to try from it
+        vector<bool> visited(w*h, false);
+        vector<vector<int> > todo(1, nextSteps(start, toGoal, visited));
+        int budget = 20000;
+
+        path.assign(1, start);
+        visited[cell(start)] = true;
+
+        while (!todo.empty() && path.back() != goal && --budget >= 0)
+        {
+            if (todo.back().empty())
+            {
+                visited[cell(path.back())] = false;
+                path.pop_back();
+                todo.pop_back();
+                continue;
+            }
+
+            const int state = todo.back().back();
+            todo.back().pop_back();
+
+            visited[cell(state)] = true;
+            path.push_back(state);
+            todo.push_back(nextSteps(state, toGoal, visited));
+        }
+
+        return !path.empty() && path.back() == goal;
     }
 
-    return true;
-}
+    // Where to go next from a state, in the order to try them from the back:
+    // closest to the goal first, staying away from where the line has already
+    // been so there's room to come back past it
+    vector<int> nextSteps(int state, const vector<int>& toGoal, const vector<bool>& visited) const
+    {
+        vector<pair<int, int> > next;
+        vector<int> result;
 
-bool GameAI::validLine(Coord a, Coord b, bool up) const
+        for (int dir = 0; dir < 4; dir++)
+        {
+            const int to = step(state, dir);
+
+            if (to == -1 || toGoal[to] == -1 || visited[cell(to)])
+                continue;
+
+            int length = toGoal[to];
+
+            for (int side = 0; side < 4; side++)
+            {
+                const int x = cell(to)%w + stepX[side];
+                const int y = cell(to)/w + stepY[side];
+
+                if (x >= 0 && x < w && y >= 0 && y < h && visited[y*w + x] &&
+                    y*w + x != cell(state))
+                    length += crowded;
+            }
+
+            next.push_back(make_pair(length, to));
+        }
+
+        sort(next.rbegin(), next.rend());
+
+        for (int i = 0; i < next.size(); i++)
+            result.push_back(next[i].second);
+
+        return result;
+    }
+};
+
+// Search grids over the board for lines between the two nodes that don't touch
+// anything else, first halfway between everything to leave room for later
+// moves and then closer. When the move splits a region, which side each of the
+// region's other groups of lines ends up on depends on the way the line goes
+// around them, so search for each combination of that.
+Line GameAI::findLine(const AbstractMove& move, Coord& middle, bool exact) const
 {
-    Coord temp;
-    if(up)
+    const Position position(state());
+    const Position target = position.play(move);
+    const Region& region = position.getRegions()[move.region];
+    const Node& start = *nodes[region[move.boundary1][move.index1]];
+    const Node& end = *nodes[region[move.boundary2][move.index2]];
+    const int maxOthers = 6;
+    vector<Coord> others;
+    vector<Line> tried;
+    Line line;
+
+    if (exact && move.boundary1 == move.boundary2)
     {
-        temp.x = a.x;
-        temp.y = b.y;
-        for (int i = 0; i < lines.size(); i++)
+        for (int b = 0; b < region.size(); b++)
+            if (b != move.boundary1)
+                others.push_back(nodes[region[b][0]]->getLoci());
+
+        // Past that there are too many combinations to search, so only keep
+        // track of some and hope the rest end up on the right side
+        if (others.size() > maxOthers)
+            others.resize(maxOthers);
+
+        // Parts of the boundary being split can also hang out to either side
+        // of the line, so keep track of going around those as well if there's
+        // room for them
+        const Boundary& boundary = region[move.boundary1];
+
+        for (int i = 0; i < boundary.size() && others.size() < maxOthers; i++)
         {
-            const Line& line = *lines[i];
+            const Coord& loci = nodes[boundary[i]]->getLoci();
 
-            if (!validSingleLine(line, a, temp))
-                return false;
+            if (&start != nodes[boundary[i]] && &end != nodes[boundary[i]] &&
+                find(others.begin(), others.end(), loci) == others.end())
+                others.push_back(loci);
         }
-        for (int i = 0; i < lines.size(); i++)
-        {
-            const Line& line = *lines[i];
+    }
 
-            if (!validSingleLine(line, temp, b))
-                return false;
+    for (int parts = 2; parts <= 8; parts *= 2)
+        if (routeLine(start, end, others, exact?&target:NULL, parts, tried, line, middle))
+            return line;
+
+    throw NoLineFound();
+}
+
+// Search one grid for findLine(), trying each new line in a copy of the game
+// until one gives the target position, or with no target any it allows
+bool GameAI::routeLine(const Node& start, const Node& end, const vector<Coord>& others,
+    const Position* target, int parts, vector<Line>& tried, Line& found, Coord& middle) const
+{
+    const GameState s = state();
+    RouteGrid grid;
+
+    for (int i = 0; i < nodes.size(); i++)
+    {
+        grid.xs.push_back(nodes[i]->getLoci().x);
+        grid.ys.push_back(nodes[i]->getLoci().y);
+    }
+
+    for (int i = 0; i < lines.size(); i++)
+    {
+        for (int j = 0; j < lines[i]->size(); j++)
+        {
+            grid.xs.push_back((*lines[i])[j].x);
+            grid.ys.push_back((*lines[i])[j].y);
         }
     }
-    else
+
+    // Leave room around the outside in proportion to what's drawn so lines
+    // going around everything aren't squeezed against it
+    const int width = *max_element(grid.xs.begin(), grid.xs.end()) - *min_element(grid.xs.begin(), grid.xs.end());
+    const int height = *max_element(grid.ys.begin(), grid.ys.end()) - *min_element(grid.ys.begin(), grid.ys.end());
+    const int margin = max(20, max(width, height)/4);
+
+    grid.xs = spread(grid.xs, margin, parts);
+    grid.ys = spread(grid.ys, margin, parts);
+    grid.w = grid.xs.size();
+    grid.h = grid.ys.size();
+    grid.others = others;
+    grid.groups = 1 << others.size();
+    grid.crowded = margin;
+    grid.room = 40;
+    grid.blocked.assign(grid.w*grid.h, false);
+
+    const vector<int>& xs = grid.xs;
+    const vector<int>& ys = grid.ys;
+    const int w = grid.w;
+
+    // Everything already drawn is on the grid points, so a line can go between
+    // two neighboring points if neither is used
+    for (int i = 0; i < nodes.size(); i++)
+        grid.blocked[column(ys, nodes[i]->getLoci().y)*w + column(xs, nodes[i]->getLoci().x)] = true;
+
+    for (int i = 0; i < lines.size(); i++)
+    {
+        const Line& line = *lines[i];
+
+        for (int j = 1; j < line.size(); j++)
+            for (int x = column(xs, min(line[j-1].x, line[j].x)); x <= column(xs, max(line[j-1].x, line[j].x)); x++)
+                for (int y = column(ys, min(line[j-1].y, line[j].y)); y <= column(ys, max(line[j-1].y, line[j].y)); y++)
+                    grid.blocked[y*w + x] = true;
+    }
+
+    const int startX = column(xs, start.getLoci().x);
+    const int startY = column(ys, start.getLoci().y);
+    const int endX = column(xs, end.getLoci().x);
+    const int endY = column(ys, end.getLoci().y);
+
+    grid.ends[0] = startY*w + startX;
+    grid.ends[1] = endY*w + endX;
+    grid.measure();
+
+    for (int first = 0; first < 4; first++)
     {
-        temp.x = b.x;
-        temp.y = a.y;
-        for (int i = 0; i < lines.size(); i++)
+        const int x = startX + stepX[first];
+        const int y = startY + stepY[first];
+
+        if (!canLeave(start, first) || x < 0 || x >= w || y < 0 || y >= grid.h ||
+            !grid.open(y*w + x))
+            continue;
+
+        const int begin = (y*w + x)*grid.groups + crossed(others, start.getLoci().x, xs[x], ys[y]);
+        vector<int> from;
+        vector<int> length;
+
+        grid.search(begin, from, length);
+
+        // Try each way of coming into the end node
+        for (int last = 0; last < 4; last++)
         {
-            const Line& line = *lines[i];
+            const int lx = endX + stepX[last];
+            const int ly = endY + stepY[last];
 
-            if (!validSingleLine(line, a, temp))
-                return false;
+            if (!canLeave(end, last, (&start == &end)?first:-1) ||
+                lx < 0 || lx >= w || ly < 0 || ly >= grid.h || !grid.open(ly*w + lx))
+                continue;
+
+            for (int bits = 0; bits < grid.groups; bits++)
+            {
+                vector<int> path;
+
+                if (!grid.simplePath(begin, (ly*w + lx)*grid.groups + bits, from, path))
+                    continue;
+
+                // Once a line works, try it again spaced out from itself
+                bool drawn = false;
+
+                for (int spaced = 0; spaced < 2 && (spaced == 0 || drawn); spaced++)
+                {
+                    if (spaced && !grid.spaceOut(path))
+                        break;
+
+                    Line line(1, start.getLoci());
+
+                    for (int i = 0; i < path.size(); i++)
+                        line.push_back(Coord(xs[grid.cell(path[i])%w], ys[grid.cell(path[i])/w]));
+
+                    line.push_back(end.getLoci());
+                    line = straighten(line);
+
+                    if (find(tried.begin(), tried.end(), line) != tried.end())
+                        continue;
+
+                    tried.push_back(line);
+
+                    // Put the middle node halfway along the longest part
+                    int longest = 0;
+
+                    for (int i = 1; i < line.size(); i++)
+                        if (distance(line[i-1], line[i]) > distance(line[longest], line[longest+1]))
+                            longest = i-1;
+
+                    if (distance(line[longest], line[longest+1]) < 4)
+                        continue;
+
+                    const Coord& a = line[longest];
+                    const Coord& b = line[longest+1];
+                    const Coord center(middleOf(xs, a.x, b.x), middleOf(ys, a.y, b.y));
+                    Game game(s);
+
+                    if (game.checkMove(line, center) != MoveOK)
+                        continue;
+
+                    game.doMove(line, center);
+
+                    if (!target || Position(game.state()) == *target)
+                    {
+                        found = line;
+                        middle = center;
+                        drawn = true;
+                    }
+                }
+
+                if (drawn)
+                    return true;
+            }
         }
-        for (int i = 0; i < lines.size(); i++)
-        {
-            const Line& line = *lines[i];
+    }
 
-            if (!validSingleLine(line, temp, b))
-                return false;
+    return false;
+}
+
+Coord GameAI::midNode(const Line& currentLine) const
+{
+    int longestIndex = -1;
+    double greatestDist = 0;
+
+    for (int i = 1; i < currentLine.size(); i++)
+    {
+        double currentDist = distance(currentLine[i], currentLine[i-1]);
+
+        if (currentDist > greatestDist)
+        {
+            greatestDist = currentDist;
+            longestIndex = i;
         }
     }
 
-    return true;
+    // Something went wrong, just pick the middle
+    if (longestIndex == -1)
+        longestIndex = currentLine.size()/2;
+
+    return Coord((currentLine[longestIndex-1].x+currentLine[longestIndex].x)/2,
+                 (currentLine[longestIndex-1].y+currentLine[longestIndex].y)/2);
+
+}
+
+bool GameAI::validLine(Coord start, Coord end) const
+{
+    return !segments().crosses(start, end);
+}
+
+// Going up or down first and then to the side, or the other way around
+bool GameAI::validLine(Coord a, Coord b, bool up) const
+{
+    const Coord corner = up?Coord(a.x, b.y):Coord(b.x, a.y);
+
+    return validLine(a, corner) && validLine(corner, b);
 }
 
 double GameAI::distance(Coord a, Coord b) const
@@ -2,7 +2,7 @@
 
 GameGUI::GameGUI(SDL_Surface* screen, TTF_Font* font)
     :GameAI(), screen(screen), font(font), playerMode(PvP), state(Blank),
-    nodeRadius(5), lineThick(1), player1(true), error(false)
+    sceneAt(-1), nodeRadius(5), lineThick(1), player1(true), error(false)
 {
     textCol.r = 255;
     textCol.g = 255;
@@ -16,6 +16,7 @@ void GameGUI::init(Mode mode, int count, int radius, int thick)
     lineThick = thick;
     player1 = true;
     error = false;
+    sceneAt = -1; // Sizes may have changed
     if (nodes.size() == 0)
     {
         double theta = 0;
@@ -44,12 +45,55 @@ void GameGUI::init(Mode mode, int count, int radius, int thick)
 
 void GameGUI::redraw(bool lck)
 {
+    SDL_Surface* layer = scene.get(screen);
+
+    // Draw the scene again only if something was played, and otherwise use
+    // the one we have. If there's no memory for it, draw it on the screen.
+    if (!layer)
+    {
+        SDL_FillRect(screen, NULL, 0);
+        drawScene(screen);
+        damage.addAll();
+    }
+    else if (sceneAt != changeCount() || !Damage::partial(screen))
+    {
+        if (sceneAt != changeCount())
+        {
+            SDL_FillRect(layer, NULL, 0);
+            drawScene(layer);
+            sceneAt = changeCount();
+        }
+
+        SDL_BlitSurface(layer, NULL, screen, NULL);
+        damage.addAll();
+    }
+    else
+    {
+        // The screen still has this scene, so only take off what's over it
+        for (int i = 0; i < over.size(); i++)
+        {
+            SDL_Rect from = over[i];
+            SDL_Rect to = over[i];
+            SDL_BlitSurface(layer, &from, screen, &to);
+            damage.add(over[i]);
+        }
+    }
+
+    over.clear();
+
     if (lck)
         lock();
 
-    // Blank screen
-    SDL_FillRect(screen, NULL, 0);
+    // Draw temporary line
+    for (int i = 1; i < currentLine.size(); i++)
+        line(currentLine[i-1], currentLine[i], (player1)?player1Col:player2Col);
+
+    if (lck)
+        unlock();
+}
 
+void GameGUI::drawScene(SDL_Surface* target)
+{
     // Draw nodes
     for (int i = 0; i < nodes.size(); i++)
     {
@@ -63,20 +107,13 @@ void GameGUI::redraw(bool lck)
             color = 0xFE0208FF;
         else if (connections == 3)
             color = 0x000000FF;
-        circle(nodes[i]->getLoci(), nodeRadius, color);
+        circle(nodes[i]->getLoci(), nodeRadius, color, target);
     }
 
     // Draw lines
     for (int i = 0; i < lines.size(); i++)
         for (int j = 1; j < lines[i]->size(); j++)
-            line((*lines[i])[j-1], (*lines[i])[j], lineCol);
-
-    // Draw temporary line
-    for (int i = 1; i < currentLine.size(); i++)
-        line(currentLine[i-1], currentLine[i], (player1)?player1Col:player2Col);
-
-    if (lck)
-        unlock();
+            line((*lines[i])[j-1], (*lines[i])[j], lineCol, target);
 }
 
 // Lock the screen so we can access it
@@ -85,7 +122,7 @@ void GameGUI::lock()
     SDL_LockSurface(screen);
 }
 
-// Unlock and show it (double buffering)
+// Unlock and show what changed
 void GameGUI::unlock()
 {
     SDL_UnlockSurface(screen);
@@ -96,7 +133,7 @@ void GameGUI::unlock()
     if (error)
         displayError("Error: Please connect at 180 degrees.");
 
-    SDL_Flip(screen);
+    damage.present(screen);
 }
 
 void GameGUI::cancel()
@@ -213,13 +250,19 @@ State GameGUI::click(Coord location)
                 if (gameEnded())
                     state = GameEnd;
 
-                if (playerMode == PvAI)
+                if (playerMode == PvAI && state != GameEnd)
                 {
                     //cout << "AI playing." << endl;
 
-                    // Computer plays.
+                    // Computer plays. If there's no room for any of its moves
+                    // it can't move either, so it loses.
                     if(aiTurn())
                         player1 = !player1;
+                    else
+                        state = GameEnd;
+
+                    if (gameEnded())
+                        state = GameEnd;
                 }
             }
         }
@@ -266,8 +309,8 @@ void GameGUI::cursor(Coord location)
 
     if (state == NodeClicked)
     {
-        lock();
         redraw(false);
+        lock();
 
         if (currentLine.size() == 1) //If it is the first line drawn out of node
         {
@@ -395,16 +438,52 @@ Coord GameGUI::center() const
     return Coord(screen->w/2, screen->h/2);
 }
 
-void GameGUI::line(Coord a, Coord b, Uint32 color)
+// Lines are lineThick pixels out from each side of the points, and go that far
+// past the ends so the segments of a line meet in a square corner. Lines in
+// the game only go up, down, left, or right, so that's a filled rectangle.
+void GameGUI::line(Coord a, Coord b, Uint32 color, SDL_Surface* target)
 {
+    if (!target)
+    {
+        target = screen;
+        drawnOver(min(a.x, b.x) - lineThick, min(a.y, b.y) - lineThick,
+                  abs(a.x - b.x) + 2*lineThick, abs(a.y - b.y) + 2*lineThick);
+    }
+
+    if (a.x == b.x || a.y == b.y)
+    {
+        boxColor(target, min(a.x, b.x) - lineThick, min(a.y, b.y) - lineThick,
+                 max(a.x, b.x) + lineThick - 1, max(a.y, b.y) + lineThick - 1, color);
+        return;
+    }
+
+    // Anything else is drawn as the same line moved around to cover the width
     for (int i = -lineThick; i < lineThick; i++)
         for (int j = -lineThick; j < lineThick; j++)
-            lineColor(screen, a.x+i, a.y+j, b.x+i, b.y+j, color);
+            lineColor(target, a.x+i, a.y+j, b.x+i, b.y+j, color);
 }
 
-void GameGUI::circle(Coord p, int radius, Uint32 color)
+void GameGUI::circle(Coord p, int radius, Uint32 color, SDL_Surface* target)
 {
-    filledCircleColor(screen, p.x, p.y, radius, color);
+    if (!target)
+    {
+        target = screen;
+        drawnOver(p.x - radius, p.y - radius, 2*radius + 1, 2*radius + 1);
+    }
+
+    filledCircleColor(target, p.x, p.y, radius, color);
+}
+
+void GameGUI::drawnOver(int x, int y, int w, int h)
+{
+    SDL_Rect r;
+    r.x = x;
+    r.y = y;
+    r.w = w;
+    r.h = h;
+
+    over.push_back(r);
+    damage.add(r);
 }
 
 // Select the closest node to the point if within the nodeRadius, otherwise
@@ -413,15 +492,20 @@ Node* GameGUI::selectedNode(Coord point) const
 {
     int closestIndex = -1;
     double minDist = numeric_limits<double>::infinity();
+    vector<int> near;
 
-    for (int i = 0; i < nodes.size(); i++)
+    nodeIndex().findIn(Coord(point.x - nodeRadius, point.y - nodeRadius),
+                       Coord(point.x + nodeRadius, point.y + nodeRadius), near);
+
+    for (int i = 0; i < near.size(); i++)
     {
-        double currentDist = distance(nodes[i]->getLoci(), point);
+        double currentDist = distance(nodes[near[i]]->getLoci(), point);
 
-        if (currentDist < minDist)
+        // Same as looking through them in order if two are as close
+        if (currentDist < minDist || (currentDist == minDist && near[i] < closestIndex))
         {
             minDist = currentDist;
-            closestIndex = i;
+            closestIndex = near[i];
         }
     }
 
@@ -436,256 +520,41 @@ double GameGUI::distance(Coord a, Coord b) const
     return sqrt(pow(1.0*a.x-b.x,2)+pow(1.0*a.y-b.y,2));
 }
 
-// Determine if the line from the coordinates start to end would cross any line
-// segments in the passed in Line.
-bool GameGUI::validSingleLine(const Line& line, Coord start, Coord end,int lineSize, bool node) const
-{
-    const int startX = start.x;
-    const int startY = start.y;
-    const int endX = end.x;
-    const int endY = end.y;
-
-    for (int j = 1; j < lineSize; j++)
-    {
-        const int A2 = line[j-1].x;
-        const int B2 = line[j-1].y;
-        const int A3 = line[j].x;
-        const int B3 = line[j].y;
-
-        //verticle line being drawn
-        if (endX == startX)
-        {
-            //pre existing horizontal
-            if(A2 != A3)
-            {
-                //determines existing line
-                if(A2 > A3)
-                {
-                    //checks if our new line crosses the horizontal line on the x axis
-                    if((startX > A3)&&(startX < A2))
-                    {
-                        //determines our current line
-                        if(startY > endY)
-                        {
-                            if(!node){//checks if our current line corsses on the y axis
-                                if((B2 <= startY)&&(B2 >= endY))
-                                    return false;
-                            }
-                            else
-                                if((B2 < startY)&&(B2 > endY))
-                                    return false;
-                        }
-                        else
-                            if(!node){
-                                if((B2 >= startY)&&(B2 <= endY)) //only difference from above is direction line was drawn
-                                    return false;
-                            }
-                            else
-                                if((B2 > startY)&&(B2 < endY)) //only difference from above is direction line was drawn
-                                    return false;
-
-                    }
-                }
-                else
-                    if((startX < A3)&&(startX > A2)) //only difference from above is direction line was drawn
-                    {
-                        if(startY > endY)
-                        {
-                            if(!node){
-                                if((B2 <= startY)&&(B2 >= endY))
-                                    return false;
-                            }
-                            else
-                                if((B2 < startY)&&(B2 > endY))
-                                    return false;
-                        }
-                        else
-                            if(!node){
-                                if((B2 >= startY)&&(B2 <= endY))
-                                    return false;
-                            }
-                            else
-                                if((B2 > startY)&&(B2 < endY))
-                                    return false;
-
-                    }
-            }
-            else
-                if(startX == A2) //check for line verticle line being drawn against other vertcle lines
-                {
-                    if(B2 > B3) //defines the pre existing line
-                    {
-                        if(((startY > B3)&&(startY <B2))||((endY > B3)&&(endY < B2))) //checks if our line shares similar y values intersect
-                            return false;
-                        if(startY < endY)
-                        {
-                            if((startY < B3)&&(endY > B3)) //also needed to check if y intercepts intersect
-                                return false;
-                        }
-                        else
-                            if((startY > B2)&&(endY < B2))//same as above comment only our current line is oriented in the other direction
-                                return false;
-                    }
-                    else//same as above only for existing line in other direction
-                    {
-                        if(((startY > B2)&&(startY < B3))||((endY > B2)&&(endY < B3)))
-                            return false;
-                        if(startY < endY)
-                        {
-                            if((startY < B2)&&(endY > B2))
-                                return false;
-                        }
-                        else
-                            if((startY > B3)&&(endY < B3))
-                                return false;
-                    }
-                }
-
-        }
-        else//same as above only for horizontal lines not horrizontal lines
-        {
-            if(B2 != B3)
-            {
-                if(B2 > B3)
-                {
-                    if((startY < B2)&&(startY > B3))
-                    {
-                        if(startX > endX)
-                        {
-                            if(!node){
-                                if((A2 <= startX)&&(A2 >= endX))
-                                    return false;
-                            }
-                            else
-                                if((A2 < startX)&&(A2 > endX))
-                                    return false;
-                        }
-                        else
-                            if(!node){
-                                if((A2 >= startX)&&(A2 <= endX))
-                                    return false;
-                            }
-                            else
-                                if((A2 > startX)&&(A2 < endX))
-                                    return false;
-                    }
-                }
-                else
-                    if((startY > B2)&&(startY < B3))
-                    {
-                        if(startX > endX)
-                        {
-                            if(!node){
-                                if((A2 <= startX)&&(A2 >= endX))
-                                    return false;
-                            }
-                            else
-                                if((A2 < startX)&&(A2 > endX))
-                                    return false;
-
-                        }
-                        else
-                            if(!node){
-                                if((A2 >= startX)&&(A2 <= endX))
-                                    return false;
-                            }
-                            else
-                                if((A2 > startX)&&(A2 < endX))
-                                    return false;
-
-                    }
-            }
-            else
-                if(startY == B2)
-                {
-                    if(A2 > A3)
-                    {
-                        if(((startX > A3)&&(startX < A2))||((endX > A3)&&(endX < A2)))
-                            return false;
-                        if(startX < endX)
-                        {
-                            if((startX < A3)&&(endX > A3))
-                                return false;
-                        }
-                        else
-                            if((startX > A2)&&(endX < A2))
-                                return false;
-                    }
-                    else
-                    {
-                        if(((startX > A2)&&(startX < A3))||((endX > A2)&&(endX < A3)))
-                            return false;
-                        if(startX < endX)
-                        {
-                            if((startX < A2)&&(endX > A2))
-                                return false;
-                        }
-                        else
-                            if((startX > A3)&&(endX < A3))
-                                return false;
-                    }
-                }
-        }
-    }
-
-    return true;
-}
-
-
 bool GameGUI::validLine(Coord start, Coord end, bool node) const //send in true if where the click happened was a node or false if it was not a node
 {
-    if (!validSingleLine(currentLine, start, end,currentLine.size()-1,node))
+    // Ending on a line is only allowed at a node. The last segment of the
+    // line being drawn ends where this one starts, so it's left out.
+    if (Segments(currentLine, currentLine.size()-1).crosses(start, end, !node) ||
+        segments().crosses(start, end, !node))
         return false;
 
-    //code for checking among the line currently being drawn
-    for (int i = 0; i < lines.size(); i++)
+    vector<int> near;
+
+    //for if line trys to end in node but node isn't clicked, minor problem fix
+    if (!node && nodeRadius > 0)
     {
-        const Line& line = *lines[i];
+        nodeIndex().findIn(Coord(end.x - nodeRadius + 1, end.y - nodeRadius + 1),
+                           Coord(end.x + nodeRadius - 1, end.y + nodeRadius - 1), near);
 
-        if (!validSingleLine(line, start, end,line.size(),node))
+        if (!near.empty())
             return false;
     }
 
-    //for if line trys to end in node but node isn't clicked, minor problem fix
-    for (int i = 0; i < nodes.size(); i++)//calls to each node
+    //check for if line is going directly through node, giving a boundary so
+    //lines can't pass through any part of the circle
+    if (start.x == end.x) //vertical line being drawn
     {
-            if(((end.x > nodes[i]->getLoci().x-nodeRadius)&&(end.x < nodes[i]->getLoci().x+nodeRadius))&&((end.y > nodes[i]->getLoci().y-nodeRadius)&&(end.y < nodes[i]->getLoci().y+nodeRadius)))
-                if(!node)
-                    return false;
+        if (abs(start.y - end.y) > 1)
+            nodeIndex().findIn(Coord(start.x - nodeRadius, min(start.y, end.y) + 1),
+                               Coord(start.x + nodeRadius, max(start.y, end.y) - 1), near);
     }
-
-
-    //check for if line is going directly through node
-    if(start.x==end.x)  //vertical line being drawn
+    else if (abs(start.x - end.x) > 1)
     {
-        for (int i = 0; i < nodes.size(); i++)//calls to each node
-            if((start.x-nodeRadius <= nodes[i]->getLoci().x)&&(nodes[i]->getLoci().x <= start.x+nodeRadius)) //gives a boundary so lines cant pass through any part of circle
-            {
-                if(start.y < end.y) //defines the line being drawn
-                {
-                    if((nodes[i]->getLoci().y > start.y)&&(nodes[i]->getLoci().y < end.y)) //checks for if node is between the line on the y values
-                        return false;
-                }
-                else
-                    if((nodes[i]->getLoci().y < start.y)&&(nodes[i]->getLoci().y > end.y)) //same as above just for the line being oriented the other direction
-                        return false;
-            }
+        nodeIndex().findIn(Coord(min(start.x, end.x) + 1, start.y - nodeRadius),
+                           Coord(max(start.x, end.x) - 1, start.y + nodeRadius), near);
     }
-    else
-        for (int i = 0; i < nodes.size(); i++)
-            if((start.y-nodeRadius <= nodes[i]->getLoci().y)&&(nodes[i]->getLoci().y <= start.y+nodeRadius))
-            {
-                if(start.x < end.x)
-                {
-                    if((nodes[i]->getLoci().x > start.x)&&(nodes[i]->getLoci().x < end.x))
-                        return false;
-                }
-                else
-                    if((nodes[i]->getLoci().x < start.x)&&(nodes[i]->getLoci().x > end.x))
-                        return false;
-            }
 
-    return true;
+    return near.empty();
 }
 
 void GameGUI::displayError(const string& msg)
@@ -701,6 +570,7 @@ void GameGUI::displayError(const string& msg)
 
     SDL_Surface* error = TTF_RenderText_Blended(font, msg.c_str(), textCol);
 
+    drawnOver(location.x, location.y, location.w, location.h);
     SDL_FillRect(screen, &location, 0);
     SDL_BlitSurface(error, NULL, screen , &location);
     //SDL_Flip(screen);
@@ -723,6 +593,7 @@ void GameGUI::displayPosition(Coord c)
 
     SDL_Surface* hover = TTF_RenderText_Blended(font, s.str().c_str(), textCol);
 
+    drawnOver(origin.x, origin.y, origin.w, origin.h);
     SDL_FillRect(screen, &origin, 0);
     SDL_BlitSurface(hover, NULL, screen , &origin);
     //SDL_Flip(screen);
@@ -762,3 +633,33 @@ GameGUI::~GameGUI()
 {
 
 }
+
+CachedSurface& CachedSurface::operator=(const CachedSurface&)
+{
+    SDL_FreeSurface(surface);
+    surface = NULL;
+
+    return *this;
+}
+
+CachedSurface::~CachedSurface()
+{
+    SDL_FreeSurface(surface);
+}
+
+SDL_Surface* CachedSurface::get(SDL_Surface* like)
+{
+    if (!surface)
+    {
+        const SDL_PixelFormat* f = like->format;
+
+        surface = SDL_CreateRGBSurface(SDL_SWSURFACE, like->w, like->h,
+            f->BitsPerPixel, f->Rmask, f->Gmask, f->Bmask, f->Amask);
+
+        // Copy it as it is rather than blending it onto what's there
+        if (surface)
+            SDL_SetAlpha(surface, 0, SDL_ALPHA_OPAQUE);
+    }
+
+    return surface;
+}
@@ -0,0 +1,66 @@
+#include "headers/gamestate.h"
+
+// Allocate space for everything, with points being the total number of
+// coordinates in all of the lines
+GameState::GameState(int nodes, int lines, int points, int moves)
+    :data(header + nodes*nodeSize + lines+1 + points*2, -1)
+{
+    data[0] = nodes;
+    data[1] = lines;
+    data[2] = moves;
+
+    // The first line starts at the beginning of the coordinates
+    data[lineOffset(0)] = 0;
+}
+
+Coord GameState::loci(int node) const
+{
+    return Coord(data[nodeOffset(node)], data[nodeOffset(node)+1]);
+}
+
+int GameState::connectionLine(int node, int i) const
+{
+    return data[nodeOffset(node) + 2 + i*2];
+}
+
+int GameState::connectionDest(int node, int i) const
+{
+    return data[nodeOffset(node) + 3 + i*2];
+}
+
+Line GameState::line(int i) const
+{
+    Line line;
+    int start = coordOffset() + data[lineOffset(i)]*2;
+    int end = coordOffset() + data[lineOffset(i+1)]*2;
+
+    for (int j = start; j < end; j += 2)
+        line.push_back(Coord(data[j], data[j+1]));
+
+    return line;
+}
+
+void GameState::setNode(int node, Coord loci)
+{
+    data[nodeOffset(node)] = loci.x;
+    data[nodeOffset(node)+1] = loci.y;
+}
+
+void GameState::setConnection(int node, int i, int line, int dest)
+{
+    data[nodeOffset(node) + 2 + i*2] = line;
+    data[nodeOffset(node) + 3 + i*2] = dest;
+}
+
+void GameState::setLine(int i, const Line& line)
+{
+    int start = data[lineOffset(i)];
+
+    for (int j = 0; j < line.size(); j++)
+    {
+        data[coordOffset() + (start+j)*2] = line[j].x;
+        data[coordOffset() + (start+j)*2 + 1] = line[j].y;
+    }
+
+    data[lineOffset(i+1)] = start + line.size();
+}
@@ -5,20 +5,77 @@
 #include <cstdlib> // Apparently abs(int) is here
 #include <vector>
 #include <iostream>
+#include <algorithm>
+#include "hashset.h"
 #include "structs.h"
 
 using namespace std;
 
-typedef vector<Connection*> Area;
+// A circuit of connections. This also keeps an index of its vertical line
+// segments so we can quickly tell if a point is inside of it.
+//
+// Once canonicalize() is called, the area starts at its smallest line and goes
+// in the direction that gives the smallest order (by LineCmp). Two canonical
+// areas are equal if they have exactly the same lines in the same order, and
+// they have a hash so they can usually be told apart without looking at them.
+class Area : public vector<Connection*>
+{
+    unsigned long long key;
+    bool isCanonical;
+
+    // The index splits the area into horizontal slabs at the ends of every
+    // vertical segment. slabs[i] is the top of slab i, which goes down to
+    // slabs[i+1], and crossings[i] holds the sorted x values of the vertical
+    // segments that go all the way through it.
+    vector<int> slabs;
+    vector<vector<int> > crossings;
+    bool hasIndex;
+
+    public:
+        Area() :key(0), isCanonical(false), hasIndex(false) { }
+        Area(size_type n)
+            :vector<Connection*>(n), key(0), isCanonical(false), hasIndex(false) { }
+
+        // Rotate and maybe reverse this into its canonical form and compute
+        // the hash. Call again if the connections are changed.
+        void canonicalize();
+        bool canonical() const { return isCanonical; }
+        unsigned long long hash() const { return key; }
+
+        // Call after all of the connections have been added. The index isn't
+        // updated if they're changed afterwards.
+        void buildIndex();
+        bool indexed() const { return hasIndex; }
+
+        // Same as Game::isInArea() but using the index, so O(log segments)
+        bool contains(Coord) const;
+};
+
+// Used to look up canonical areas in a HashSet
+class AreaHash
+{
+    public:
+        size_t operator()(const Area& a) const { return a.hash(); }
+};
+
+typedef HashSet<Area, AreaHash> AreaTable;
+
 typedef vector<Area*> Areaset;
 
+// Hash of the area pointers in an areaset, used to find duplicates
+class AreasetHash
+{
+    public:
+        size_t operator()(const Areaset&) const;
+};
+
 // This should really be constant, but we have to add it's address to a
 // non-const vector
 static Areaset defaultAreaset; //create default/null vector
 
 ostream& operator<<(ostream& os, const Area& a);
 
-// We need to write tests before using this.
+// Same lines in the same circular order, in either direction
 bool operator==(const Area& a,const Area& b);
 bool operator!=(const Area& a,const Area& b);
 #endif
@@ -0,0 +1,46 @@
+#ifndef H_DAMAGE
+#define H_DAMAGE
+
+#include <vector>
+#include <SDL.h>
+
+using namespace std;
+
+// The parts of the screen that have been drawn on since it was last shown, so
+// only those have to be sent to the display instead of all of it. On a
+// software screen, which is what we get in a window or over VNC, that's most
+// of the work of showing a change.
+class Damage
+{
+    vector<SDL_Rect> rects;
+    bool everything;
+
+    public:
+        Damage() :everything(false) { }
+
+        // Anything off the screen is left off when it's shown
+        void add(int x, int y, int w, int h);
+        void add(const SDL_Rect&);
+        void addAll();
+        void clear();
+        bool empty() const { return !everything && rects.empty(); }
+
+        // The rectangles to show on a screen w by h, cut to fit on it. If
+        // they'd cover most of it anyway, it's one for all of it.
+        vector<SDL_Rect> on(int w, int h) const;
+
+        // Show the damaged parts and start over
+        void present(SDL_Surface* screen);
+
+        // Whether the screen can be drawn on and shown a part at a time. A
+        // double buffered screen in video memory has to be flipped, and then
+        // what's drawn on next is the frame before, so all of it has to be.
+        static bool partial(const SDL_Surface* screen);
+
+        // Where two surfaces of the same size and format differ, as one
+        // rectangle that's empty if they're the same. False if they can't be
+        // compared.
+        static bool difference(SDL_Surface* a, SDL_Surface* b, SDL_Rect& changed);
+};
+
+#endif
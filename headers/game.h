@@ -7,11 +7,16 @@
 #define H_Game
 
 #include <map>
+#include <set>
 #include <vector>
 #include <iostream>
 #include <algorithm>
 #include "node.h"
+#include "hashset.h"
 #include "structs.h"
+#include "nodegrid.h"
+#include "segments.h"
+#include "gamestate.h"
 
 using namespace std;
 
@@ -47,9 +52,64 @@ class InvalidMiddle
 // two)
 class InvalidNode { };
 
+// How updateAreas() finds the areas. WalkAreas finds every circuit with
+// Node::walk(), which gets exponentially slower as more loops are drawn.
+// TraceAreas goes around the faces of the drawing with Node::trace(), which is
+// linear in the number of lines.
+enum AreaFinder
+{
+    WalkAreas,
+    TraceAreas
+};
+
 // Thrown when two nodes aren't connectable when put into doMove()
 class NotConnectable { };
 
+// Thrown in doMove() when verifying incremental area updates if they don't
+// match what a full updateAreas() would have given
+class AreasMismatch { };
+
+// Thrown by undoMove() when there aren't any moves left to undo
+class NoMoveToUndo { };
+
+// What checkMove() found wrong with a move. Other than MoveOK, each is what
+// doMove() would throw for it.
+enum MoveCheck
+{
+    MoveOK,
+    MoveInvalidNode,    // InvalidNode
+    MoveInvalidLine,    // InvalidLine
+    MoveInvalidMiddle,  // InvalidMiddle
+    MoveNotConnectable, // NotConnectable, or an end without the lives for it
+    MoveEntryCollision, // NodeEntryCollision
+    MoveInvalidCorner   // InvalidCorner
+};
+
+// What doMove() changed, so that undoMove() can put it back. The area changes
+// are only saved when doMove() updated the areas incrementally, and they're
+// forgotten whenever all the areas are updated again. Without them, undoing the
+// move has to update all the areas.
+struct MoveRecord
+{
+    // Where a node's areasets pointed before the move
+    struct NodeAreasets
+    {
+        Node* node;
+        Areaset* sets[2];
+    };
+
+    Node* middle;
+    bool saved; // Whether the area changes below are valid
+    vector<Area*> added; // Areas and areasets added by the move
+    vector<Areaset*> addedSets;
+    vector<Area*> removed; // Ones it removed, not deleted until they
+    vector<Areaset*> removedSets; // can't be put back anymore
+    vector<pair<Areaset*, Areaset> > changed; // Areasets and what they contained
+    vector<NodeAreasets> nodeSets;
+
+    MoveRecord(Node* middle) :middle(middle), saved(false) { }
+};
+
 class Game
 {
     // Vectors of addresses since addresses of an element in a vector will
@@ -57,11 +117,85 @@ class Game
     private:
         bool updated;
         int moveCount;
+        bool incremental; // Only update the region split by the move in doMove()
+        bool verify; // Check incremental updates against a full rebuild
+        AreaFinder finder; // Walk circuits or trace faces
         vector<Area*> areas;
+        AreaTable uniqueAreas; // Same areas, for finding duplicates
+        HashSet<Areaset, AreasetHash> uniqueAreasets; // Same areasets, for finding duplicates
+        vector<MoveRecord> history; // Moves that can be undone, last one last
+
+        // Which nodes each node can be connected to, one row per node with a
+        // bit for each node by index, packed into words. It's kept up to date
+        // along with the areas.
+        vector<vector<unsigned long> > partnerRows;
+
+        // What a node added to the lives of its areasets last time they were
+        // counted. A node on the same areaset on both sides counts once.
+        struct NodeLives
+        {
+            Areaset* sets[2];
+            int lives;
+        };
+
+        // Lives left on the live nodes of each areaset, and how many of the
+        // areasets have at least two, which is enough for a move
+        map<Areaset*, int> regionLives;
+        vector<NodeLives> counted; // By node index
+        int movableRegions;
+
+        // A move split at the middle, with the nodes on either end
+        struct PlannedMove
+        {
+            Node* a;
+            Node* b;
+            Line ac;
+            Line cb;
+            int count; // Segments the middle was on, should be one
+            Line line; // What it was planned from
+            Coord middle;
+        };
+
+        // The last move checkMove() said was fine, which doMove() doesn't have
+        // to check again as long as nothing has changed. Every node or line
+        // added or removed counts as a change.
+        mutable PlannedMove checked;
+        mutable int checkedAt; // Change it was checked at, -1 if none
+        int changes;
+
+        // The segments of all the lines. New lines are added to them, and
+        // they're found again when needed after anything else changes.
+        mutable Segments lineSegments;
+        mutable int segmentsAt; // Change they were built at, -1 if never
+
+        // Where the nodes are, by index. It's made once a game has looked up
+        // enough nodes, so copies only used for a move or two don't bother,
+        // and after that new nodes are added to it.
+        mutable NodeGrid nodeGrid;
+        mutable bool nodesIndexed;
+        mutable int nodeLookups; // Before it was made
     protected:
         vector<Areaset*> areasets;  // now protected instead of private for use in currentAreas() function
         vector<Node*> nodes;
         vector<Line*> lines;
+
+        bool sameAreas(const Game&) const; // Same areas/connectable as another copy?
+
+        // connectable() for the nodes at these indexes, from the matrix
+        bool canConnect(int a, int b) const;
+
+        // The segments of the lines, for checking if a new one crosses them
+        const Segments& segments() const;
+
+        // Where the nodes are, for finding them without looking at all of them
+        const NodeGrid& nodeIndex() const;
+
+        // Goes up every time a node or line is added or removed, so anything
+        // made from them can tell when it's out of date
+        int changeCount() const { return changes; }
+
+        // Index of the node at the point like NodeGrid::find()
+        int nodeAt(Coord, int* count = NULL) const;
     public:
         Game();
 
@@ -69,17 +203,51 @@ class Game
         Game(const Game&);
         Game& operator=(const Game&);
 
+        // Convert to and from the compact state used by the AI. Like copying,
+        // areas have to be updated after creating a game from a state.
+        Game(const GameState&);
+        GameState state() const;
+
         // This is the function you'll use a LOT. Set extraChecks to true if
         // you want the A-Checker to verify two nodes should be connectable.
         // This is useful when line-crossing code doesn't work, but it's twice
         // as slow, which is noticeable near the end of a 10+ node game.
         void doMove(const Line&, Coord middle, bool extraChecks = false);
 
+        // Whether doMove() would take this move, without changing anything or
+        // throwing. If the areas are up to date it also checks the ends are
+        // connectable like extraChecks. A move that's OK isn't checked again
+        // if it's the next thing given to doMove().
+        MoveCheck checkMove(const Line&, Coord middle) const;
+
+        // Take back the last doMove(), removing the new node and the two lines
+        // and putting the areas back the way they were. Moves are undone in the
+        // reverse order they were done in, and there can't be other nodes or
+        // lines inserted since. Copies of the game start without any moves to
+        // undo. Throws NoMoveToUndo if there aren't any.
+        void undoMove();
+
         void updateAreas(); //will call node.walk in its process
+
+        // By default doMove() only recomputes the region the new line went
+        // through. Set verify to true to compare that against a full
+        // updateAreas() after every move, which throws AreasMismatch if they
+        // differ. This is very slow, so only use it for debugging.
+        void incrementalAreas(bool enabled, bool verify = false);
+
+        // Choose how areas are found, takes effect the next time they're
+        // updated. The default is TraceAreas.
+        void areaFinder(AreaFinder);
         int moves() const; // Returns how many times doMove has been called
         bool connectable(const Node&,const Node&) const;
         bool isInArea(const Area&,Coord) const;
-        bool gameEnded() const; // Can any nodes be connected still?
+        bool gameEnded() const; // Can any nodes be connected still? O(1)
+
+        // Indexes of the nodes that can be connected to this one, including
+        // itself if it has room for a loop. Like connectable(), the areas
+        // have to be up to date.
+        vector<int> connectablePartners(const Node&) const;
+        bool anyMovesLeft() const; // Same as !gameEnded()
         // Needed for initializing nodes on the screen
         Node& insertNode(Coord, Connection = Connection(), Connection = Connection());
         Node* findNode(Coord) const; // Find node exactly at Coord, NULL if not found
@@ -93,7 +261,26 @@ class Game
         void cleanup();
         void copy(const Game&);
         void clearAreas(); // empty areas/areasets and delete items pointed to
+        void splitAreas(Node& middle, const vector<Areaset*>& split, MoveRecord&); // Incremental updateAreas() after a move
+        void restoreAreas(MoveRecord&); // Undo splitAreas()
+        void forgetAreaChanges(); // Delete what's saved for undoing moves
+        void findAreasets(Node&); // Set the areasets on both sides of a node
+        Areaset* uniqueAreaset(Areaset*); // Existing copy of the areaset if there is one
+        Coord sidePoint(const Node&, int side) const; // Point just to one side of a node
         void deleteLastNode(); // Undo last add, used in doMove
+
+        // Find the ends and split the line, checking everything doMove()
+        // does other than connectable(), which is only checked if connect is
+        // true. Doesn't change anything.
+        MoveCheck planMove(const Line&, Coord middle, PlannedMove&, bool connect) const;
+
+        // Recompute the partner rows of every node, or only the rows and
+        // columns of the nodes whose areasets or lives changed
+        void refreshPartners();
+        void refreshPartners(const vector<Node*>& changed);
+        void resizePartners(); // One row and column per node
+        void countLives(int node, int sign); // Add or take away what it counted
+        void recountLives(int node);
     public:
         virtual ~Game();
 };
@@ -1,8 +1,15 @@
 #ifndef H_Gameai
 #define H_Gameai
 
+#include <queue>
 #include <vector>
 #include "game.h"
+#include "position.h"
+#include "solver.h"
+
+// Thrown by GameAI::findLine() when there isn't room for a line that makes the
+// move
+class NoLineFound { };
 
 /*class Pmove
 {
@@ -20,18 +27,32 @@ class GameAI : public Game
         int testUnuseableNodes;
         int wantedAreas;
         bool aiFirst;
+        Solver solver;
+        bool printSearch;
     public:
         GameAI(); //needs to call game constructor;
+        GameAI(const GameState&); // Areas need updating after this
         int notConnectableNodes() const; //check how many nodes are not connectable
         void populateMList(); //will populate the possibleMoves vector
-        bool aiTurn(); //master function for making the AI have a turn
+        bool aiTurn(); // Play the best move the solver finds that there's room to draw
+        // How long the solver gets each move, and whether aiTurn() prints what
+        // it found
+        void setThinking(int milliseconds, bool print = true);
         Coord midNode(const Line&) const; //Creates a new node on the line.
         Line createLine(Node*, Node*) const; //Finds a path between two nodes
+        // Find a line doMove() accepts for a move from Position(state()), also
+        // setting where the middle node goes. If not exact, the line only has
+        // to connect the same nodes, not split the region the same way.
+        Line findLine(const AbstractMove&, Coord& middle, bool exact = true) const;
         bool requiredAreas(bool, int) const;  //Calculates the number of nodes to put the ai in an advantageous position.
-        bool validSingleLine(const Line&,Coord,Coord) const; //copy/pasted from GUI
-        bool validLine(Coord,Coord) const; // copy/pasted from GUI
+        bool validLine(Coord,Coord) const; // Whether a segment crosses any lines
         bool validLine(Coord,Coord, bool) const; // edited for right angle lines, either up first or side first
         double distance(Coord a, Coord b) const;
+    private:
+        bool routeLine(const Node& start, const Node& end, const vector<Coord>& others,
+            const Position* target, int parts, vector<Line>& tried, Line& found,
+            Coord& middle) const;
+    public:
         ~GameAI();
 };
 
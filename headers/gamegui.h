@@ -14,6 +14,7 @@
 #include "node.h"
 #include "image.h"
 #include "gameai.h"
+#include "damage.h"
 
 using namespace std;
 
@@ -25,6 +26,23 @@ enum State
     GameEnd
 };
 
+// A surface drawn to off the screen and freed along with this. It's only used
+// to save drawing things again, so copies start without one.
+class CachedSurface
+{
+    SDL_Surface* surface;
+
+    public:
+        CachedSurface() :surface(NULL) { }
+        CachedSurface(const CachedSurface&) :surface(NULL) { }
+        CachedSurface& operator=(const CachedSurface&);
+        ~CachedSurface();
+
+        // The surface, made like the screen the first time
+        SDL_Surface* get(SDL_Surface* like);
+        bool exists() const { return surface != NULL; }
+};
+
 class GameGUI : public GameAI
 {
     private:
@@ -37,6 +55,16 @@ class GameGUI : public GameAI
         Line currentLine;
         SDL_Color textCol;
 
+        // The nodes and lines that have been played, drawn when they change
+        // so moving the mouse only has to draw the line in progress
+        CachedSurface scene;
+        int sceneAt; // Game::changeCount() when it was drawn, -1 to redraw
+
+        // What's been drawn on the screen over the scene, which is copied back
+        // over it on the next redraw, and what has to be shown on unlock()
+        vector<SDL_Rect> over;
+        Damage damage;
+
         int nodeRadius; // Node radius
         int lineThick; // Line thickness
         // Assuming big-endian?
@@ -69,12 +97,17 @@ class GameGUI : public GameAI
         void unlock(); // Also draws error message(s) to screen
 
         // Redraw the background, lines, etc. Set lock to false when you draw multiple
-        // things to the screen at the same time.
+        // things to the screen at the same time, and lock it afterwards since
+        // the scene can't be copied onto a locked screen.
         void redraw(bool lock_screen = true);
-        void line(Coord, Coord, Uint32 color);        // Draw a line
-        void circle(Coord, int radius, Uint32 color); // Draw a circle
+        void drawScene(SDL_Surface*); // The nodes and lines that have been played
+
+        // Draw a line or a circle, on the screen over the scene unless given
+        // another surface
+        void line(Coord, Coord, Uint32 color, SDL_Surface* = NULL);
+        void circle(Coord, int radius, Uint32 color, SDL_Surface* = NULL);
+        void drawnOver(int x, int y, int w, int h); // Remember it's there
         bool validLine(Coord,Coord,bool) const; // See if a pending line crosses another
-        bool validSingleLine(const Line&,Coord,Coord,int,bool) const; // Used in validLine() for each of the lines, removes duplicate code
         //bool validConnection; //Checks to see if connection to the last node in a line is valid. TODO: Implement if needed
         bool vertical(Coord,Coord) const; //Checks two points and determines if line to be drawn should be vertical
         Coord straighten(Coord last, Coord point) const; // Snap point at 90 degrees angles to last
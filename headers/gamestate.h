@@ -0,0 +1,57 @@
+/*
+ * A compact copy of a game for the AI to search with. Rather than separately
+ * allocated nodes and lines pointing at each other, everything is stored by
+ * index in one array of ints, so copying a position is a single allocation and
+ * memcpy. Convert with Game::state() and Game(const GameState&).
+ *
+ * Layout of data:
+ *   [0] number of nodes, [1] number of lines, [2] number of moves
+ *   Each node: x, y, then (line, dest) for each of its three connections with
+ *     -1 for connections that don't exist
+ *   Line offsets: where each line starts in the coordinates, plus one more for
+ *     where the last line ends
+ *   Coordinates: x, y of each point of each line
+ */
+#ifndef H_GameState
+#define H_GameState
+
+#include <vector>
+#include "structs.h"
+
+using namespace std;
+
+class GameState
+{
+    vector<int> data;
+
+    static const int header = 3;
+    static const int nodeSize = 8;
+
+    public:
+        GameState() :data(header, 0) { }
+        GameState(int nodes, int lines, int points, int moves);
+
+        int nodeCount() const { return data[0]; }
+        int lineCount() const { return data[1]; }
+        int moves() const { return data[2]; }
+
+        Coord loci(int node) const;
+        int connectionLine(int node, int i) const; // -1 if no connection
+        int connectionDest(int node, int i) const; // -1 if no connection
+        Line line(int i) const;
+
+        // Used when building a state
+        void setNode(int node, Coord loci);
+        void setConnection(int node, int i, int line, int dest);
+        void setLine(int i, const Line& line); // Must be set in order
+
+        bool operator==(const GameState& s) const { return data == s.data; }
+        bool operator!=(const GameState& s) const { return data != s.data; }
+
+    private:
+        int nodeOffset(int node) const { return header + node*nodeSize; }
+        int lineOffset(int i) const { return header + nodeCount()*nodeSize + i; }
+        int coordOffset() const { return lineOffset(lineCount()+1); }
+};
+
+#endif
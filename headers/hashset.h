@@ -0,0 +1,90 @@
+/*
+ * A hash set of pointers where items are looked up by value, used to keep only
+ * one copy of each areaset. C++98 doesn't have unordered_set, and a std::set
+ * would compare whole vectors at every level of the tree.
+ *
+ * Hash is a class with an operator() that returns a size_t for a const T&, and
+ * T must have operator==. Items must not change while they're in the set since
+ * they'd end up in the wrong bucket, so erase them first and insert them again
+ * afterwards.
+ */
+#ifndef H_HASHSET
+#define H_HASHSET
+
+#include <vector>
+#include <cstddef>
+
+using namespace std;
+
+template<class T, class Hash> class HashSet
+{
+    vector<vector<T*> > buckets;
+    int count;
+    Hash hash;
+
+    public:
+        HashSet() :buckets(16), count(0) { }
+
+        // Return the item equal to this one, NULL if there isn't one
+        T* find(const T& item) const
+        {
+            const vector<T*>& bucket = buckets[hash(item) & (buckets.size()-1)];
+
+            for (int i = 0; i < bucket.size(); i++)
+                if (*bucket[i] == item)
+                    return bucket[i];
+
+            return NULL;
+        }
+
+        // Doesn't check if it's already there, use find() first
+        void insert(T* item)
+        {
+            if (count >= buckets.size())
+                grow();
+
+            buckets[hash(*item) & (buckets.size()-1)].push_back(item);
+            ++count;
+        }
+
+        // Remove this exact item (not just an equal one)
+        bool erase(T* item)
+        {
+            vector<T*>& bucket = buckets[hash(*item) & (buckets.size()-1)];
+
+            for (int i = 0; i < bucket.size(); i++)
+            {
+                if (bucket[i] == item)
+                {
+                    bucket[i] = bucket.back();
+                    bucket.pop_back();
+                    --count;
+                    return true;
+                }
+            }
+
+            return false;
+        }
+
+        void clear()
+        {
+            buckets = vector<vector<T*> >(16);
+            count = 0;
+        }
+
+        int size() const { return count; }
+
+    private:
+        // Double the number of buckets, which is always a power of two
+        void grow()
+        {
+            vector<vector<T*> > old(buckets.size()*2);
+            old.swap(buckets);
+
+            for (int i = 0; i < old.size(); i++)
+                for (int j = 0; j < old[i].size(); j++)
+                    buckets[hash(*old[i][j]) & (buckets.size()-1)].push_back(old[i][j]);
+        }
+};
+
+#endif
@@ -6,6 +6,7 @@
 #include <SDL_gfxPrimitives.h>
 #include <string>
 #include <iostream>
+#include "damage.h"
 
 using namespace std;
 
@@ -23,10 +24,23 @@ class Image
 {
     private:
         SDL_Surface *img;
+        SDL_Rect at; // Where it's drawn
+
+        static SDL_Surface* load(const string&); // In the screen's format
 
     public:
         Image(const string&, bool transparent = false);
+
+        // Only the part of the image that's different from base, like a
+        // button highlighted on a page, drawn over base where it was
+        Image(const string&, Image& base);
+
         SDL_Surface* surface();
+        const SDL_Rect& area() const { return at; }
+
+        // Draw it where it goes, or only the part of it under a rectangle
+        void draw(SDL_Surface* target, const SDL_Rect* part = NULL);
+
         ~Image();
 };
 
@@ -0,0 +1,35 @@
+#ifndef H_LATENCY
+#define H_LATENCY
+
+#include <vector>
+#include <iostream>
+#include <SDL.h>
+
+using namespace std;
+
+// How long each type of input event took, from taking it off the queue to
+// showing what it changed, as counts in buckets that double in size. SDL
+// doesn't say when an event happened, so time spent in the queue before that
+// isn't counted.
+class Latency
+{
+    vector<vector<int> > counts; // For each event type, how many in each bucket
+    int merged; // Mouse motion events skipped for a later one
+
+    public:
+        static const int buckets = 10;
+
+        Latency();
+
+        void add(Uint8 type, Uint32 ms);
+        void skipped(int count) { merged += count; }
+
+        // Under 1 ms, 1 ms, 2-3 ms, 4-7 ms, and so on, with the last one for
+        // everything longer
+        static int bucket(Uint32 ms);
+
+        // A table with a row for each type of event there was
+        void print(ostream&) const;
+};
+
+#endif
@@ -4,9 +4,11 @@
 #include <SDL.h>
 #include <SDL_gfxPrimitives.h>
 #include <string>
+#include <vector>
 #include <algorithm>
 #include "image.h"
 #include "structs.h"
+#include "damage.h"
 
 enum Mode // values attached to the playerMode variable. They represent "player vs player" and "player vs AI"
 {
@@ -19,6 +21,36 @@ enum ClickType // values return from the click functions. They are used to deter
     CONTINUE, GAME, EXIT
 };
 
+// Where a button is on a page and the image of it highlighted, in menu.cpp
+struct Button;
+
+// A page of the menu and the buttons on it, which are highlighted by drawing
+// only the part of their image that's different over the page. The images
+// are loaded the first time they're needed or by loadNext().
+class Page
+{
+    private:
+        string file;
+        Image* background; // NULL until it's loaded
+        const Button* buttons;
+        vector<Image*> highlights; // For each of the buttons, NULL until loaded
+
+        Image& highlight(int button);
+
+        // Not copied
+        Page(const Page&);
+        Page& operator=(const Page&);
+
+    public:
+        Page(const string&, const Button*, int count);
+
+        Image& image();
+        Image* highlight(Coord); // The highlighted button under the cursor, NULL if none
+        bool loadNext(); // Load one of the images, false if they all are
+
+        ~Page();
+};
+
 class Menu
 {
     private:
@@ -29,46 +61,16 @@ class Menu
 
         Mode playerMode; // One player or two
         int numberOfNodes; // can be anything but the menu only allows for 3 to 7
-        // All of the different pages and buttons in the menu are different images blitted onto the background
+        // All of the different pages are different images blitted onto the background, and the buttons
+        // on them are parts of images blitted over those when they're highlighted
         // The following variables are loaded with the different images in the menu.cpp file
-        Image sproutsMenu;
-        Image startHover;
-        Image optionsHover;
-        Image instructionsHover;
-        Image creditsHover;
-        Image exitHover;
-
-        Image options;
-        Image optionsSmallNodeHover;
-        Image optionsMediumNodeHover;
-        Image optionsLargeNodeHover;
-        Image optionsSmallLineHover;
-        Image optionsMediumLineHover;
-        Image optionsLargeLineHover;
-        Image optionsThreeNodesHover;
-        Image optionsFourNodesHover;
-        Image optionsFiveNodesHover;
-        Image optionsSixNodesHover;
-        Image optionsSevenNodesHover;
-        Image optionsPvPHover;
-        Image optionsPvAIHover;
-        Image optionsBackHover;
-
-        Image instructions;
-        Image instructionsBackHover;
-
-        Image credits;
-        Image creditsBackHover;
-
-        Image computerWins;
-        Image computerWinsExitHover;
-        Image computerWinsMenuHover;
-        Image playerOneWins;
-        Image playerOneWinsExitHover;
-        Image playerOneWinsMenuHover;
-        Image playerTwoWins;
-        Image playerTwoWinsExitHover;
-        Image playerTwoWinsMenuHover;
+        Page sproutsMenu;
+        Page options;
+        Page instructions;
+        Page credits;
+        Page computerWins;
+        Page playerOneWins;
+        Page playerTwoWins;
 
         // the following variables are used to direct the menu and tell which page to show and which buttons to use
         bool GameStart;
@@ -81,15 +83,21 @@ class Menu
         bool p2Wins;
         bool aiWins;
 
-        // the following variables are used to prevent the code from attempting to upload the same background twice in a row
-        bool check[37];
+        // What's on the screen, so the same thing isn't drawn twice in a row
+        // and only the buttons that changed are drawn again
+        Page* shown; // NULL if it's the game
+        Image* highlighted; // NULL if no button is highlighted
+        Damage damage;
+
+        Page& overPage(); // Which game over page to show
 
     public:
         // the constructor function
         Menu(SDL_Surface*);
 
         // the nonconstructor functions
-        void menuFlip(SDL_Surface*, bool&); // This function makes the background in the menu look like the contents of one of the Image clss variables
+        void show(Page&, Image* highlight = NULL); // This function makes the background in the menu look like one of the pages
+        bool loadNext(); // Load one more of the images so they're ready when shown, false if they all are
         void init(); // Show the menu the first time
         void over(bool); // Tell menu that the game is over
         void cancel(); // Esc pressed
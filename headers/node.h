@@ -1,6 +1,7 @@
 #ifndef H_Node
 #define H_Node
 
+#include <set>
 #include <vector>
 #include <cstdlib>
 #include <iostream>
@@ -81,8 +82,12 @@ class Node
 
         Node(Coord, Connection = Connection(), Connection = Connection());
         //Append new circuits/areas to this vector: be sure to check if exists
-        void walk(vector<Area*>&);
-        void walk(vector<Area*>&, Area, Connection*, Node*);
+        // The table has all the areas in the vector for finding duplicates
+        void walk(vector<Area*>&, AreaTable&);
+        void walk(vector<Area*>&, AreaTable&, Area, Connection*, Node*);
+        // Alternative to walk(): follow the faces of the drawing starting from
+        // each connection not already in traced, adding them to traced
+        void trace(vector<Area*>&, AreaTable&, set<Connection*>& traced);
         Connection* getConnAddr(); //return array connection
         bool dead() const; //true if dead node
         bool vertical() const; // runs on assumption that there are two connections; if we implement exceptions should thrown one if it does NOT have two nodes
@@ -91,6 +96,19 @@ class Node
         bool addConnection(const Connection&); // adds connection to first available slot, returns false if all used already
         int conCount() const; // The number of connections
 
+        // What updateOpen() would find wrong after adding connections on
+        // these lines (the second can be NULL), without adding them
+        enum Entry
+        {
+            EntryOK,
+            EntryFull,      // Not enough room for them
+            EntryBadLine,   // InvalidLine
+            EntryCollision, // NodeEntryCollision
+            EntryCorner     // InvalidCorner
+        };
+
+        Entry checkEntry(const Line*, const Line* = NULL) const;
+
         // Determine which sides you can connect on. Note this assumes that x
         // increases from left to right and y increases from top to bottom.
         // (0,0) is the top left in most graphical toolkits.
@@ -105,6 +123,10 @@ class Node
         friend ostream& operator<<(ostream&, const Connection&);
     private:
         void updateOpen(); // update open array after adding a connection
+        Dir direction(const Line&) const; // Side of the node the line is on
+        bool side(const Line&, Dir&) const; // Same but false if it isn't valid
+        Entry openings(const Line* const in[], int count, bool sides[4]) const; // Sides left open by these lines
+        Connection* next(const Line*); // Connection after this line turning clockwise
 };
 
 // This is here since we want to print out the coordinate of the Node
@@ -0,0 +1,40 @@
+#ifndef H_NODEGRID
+#define H_NODEGRID
+
+#include <vector>
+#include "structs.h"
+
+using namespace std;
+
+// Where the nodes are, for finding the ones at or near a point without looking
+// at all of them. Nodes are known by their index in the game and hashed by the
+// grid square they're in. Each bucket is a list through next[] of the nodes
+// in it, the most recently added first, so taking off the last node added
+// only has to look at the start of its list.
+class NodeGrid
+{
+    vector<int> heads;    // First node in each bucket, -1 if none
+    vector<int> next;     // Node after each one in its bucket, -1 if none
+    vector<Coord> points; // Where each node is
+
+    int bucket(int x, int y) const; // For the square at x, y in squares
+    void rehash(int buckets);
+
+    public:
+        NodeGrid() { }
+
+        void clear();
+        void add(Coord); // The next node
+        void removeLast();
+        int size() const { return points.size(); }
+
+        // The lowest index of a node exactly at the point, -1 if there isn't
+        // one. If count isn't NULL, it's set to how many there are.
+        int find(Coord, int* count = NULL) const;
+
+        // Add the nodes inside the rectangle from one corner to the other,
+        // including its edges, to found in no particular order
+        void findIn(Coord from, Coord to, vector<int>& found) const;
+};
+
+#endif
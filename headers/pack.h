@@ -0,0 +1,66 @@
+#ifndef H_PACK
+#define H_PACK
+
+#include <string>
+#include <SDL.h>
+
+using namespace std;
+
+// The images already decoded into one file of raw pixels, made by the pack
+// tool, so loading one at startup is only pointing a surface at part of the
+// file instead of decoding a JPEG. The file is mapped into memory, so only
+// the images used are read from disk.
+//
+// It's laid out as a header, an entry for each image, and then the pixels of
+// each, all in the byte order of the computer it was made on. Images that
+// were changed after it was made are loaded from their files.
+namespace PackFormat
+{
+    static const char magic[8] = { 'S', 'P', 'R', 'P', 'A', 'C', 'K', '1' };
+
+    // 32 bit pixels, 0x00RRGGBB
+    static const Uint32 rmask = 0x00FF0000;
+    static const Uint32 gmask = 0x0000FF00;
+    static const Uint32 bmask = 0x000000FF;
+
+    struct Header
+    {
+        char magic[8];
+        Uint32 count; // Entries following this
+    };
+
+    struct Entry
+    {
+        char name[120]; // The path the game loads it by, e.g. images/Options.jpg
+        Uint32 size;    // Bytes in that file when it was packed
+        Uint32 w, h;
+        Uint32 offset;  // From the start of the file to the pixels, w*4 bytes a row
+    };
+}
+
+class Pack
+{
+    const char* data; // The mapped file, NULL if there isn't one
+    size_t length;
+    void* mapping;    // What has to be closed on Windows
+
+    Pack(const string& file);
+    void close(); // Unmap it, if it was mapped
+
+    // Not copied
+    Pack(const Pack&);
+    Pack& operator=(const Pack&);
+
+    public:
+        // The one next to the images, opened the first time
+        static Pack& assets();
+
+        // A surface using the packed pixels of the image, which has to be
+        // freed and is only valid as long as the pack, or NULL if it's not in
+        // the pack or the file changed
+        SDL_Surface* surface(const string& name) const;
+
+        ~Pack();
+};
+
+#endif
@@ -0,0 +1,96 @@
+/*
+ * An abstract Sprouts position that only keeps what matters for playing, not
+ * where anything is drawn. It's written with the usual notation for this: each
+ * region of the plane has boundaries, each boundary is the vertices in order
+ * going around one connected group of lines (or a single vertex), and each
+ * vertex has some number of lives left (three minus the lines coming out of
+ * it). Dead vertices and regions nothing can be played in anymore are dropped.
+ *
+ * Vertices are numbered like the nodes of the game they came from, and the
+ * vertex added by a move gets the next number just like doMove() appends the
+ * middle node, so a move played here and the same move played in a Game give
+ * the same position.
+ */
+#ifndef H_Position
+#define H_Position
+
+#include <string>
+#include <vector>
+#include <iostream>
+#include "gamestate.h"
+
+using namespace std;
+
+// The vertices going around one boundary with the region on the left, and the
+// boundaries of one region
+typedef vector<int> Boundary;
+typedef vector<Boundary> Region;
+
+// A line from one vertex to another (or itself) through a region. The ends are
+// given by where they are on the region's boundaries since a vertex can be on
+// them more than once.
+struct AbstractMove
+{
+    int region;
+    int boundary1, index1; // Start
+    int boundary2, index2; // End
+
+    // When both ends are on the same boundary, the line splits the region in
+    // two. For each of the region's other boundaries in order, whether it ends
+    // up in the new region along the boundary from the start to the end.
+    vector<bool> group;
+
+    AbstractMove() :region(0), boundary1(0), index1(0), boundary2(0), index2(0) { }
+};
+
+class Position
+{
+    vector<int> lives; // By vertex, zero once dead
+    vector<Region> regions;
+
+    public:
+        Position() { }
+        Position(int spots); // The start of a game
+        Position(const GameState&);
+
+        int vertexCount() const { return lives.size(); }
+        int livesLeft(int vertex) const { return lives[vertex]; }
+        const vector<Region>& getRegions() const { return regions; }
+        bool ended() const { return regions.empty(); }
+
+        // Every legal move, and the position after one of them
+        vector<AbstractMove> moves() const;
+        Position play(const AbstractMove&) const;
+
+        // Split into parts that can be played separately, each one the
+        // regions that share vertices with each other but not with the rest.
+        // A move in one part doesn't change what can be done in the others.
+        vector<Position> components() const;
+
+        // The same vertices with the same lives in the same regions, ignoring
+        // the order of the regions and boundaries and where each boundary
+        // starts
+        bool operator==(const Position&) const;
+        bool operator!=(const Position& p) const { return !(*this == p); }
+
+        // Written like "0.0.0}!" for three spots: 0, 1, and 2 are vertices with
+        // that many lines, letters are vertices that are on the boundaries more
+        // than once, boundaries are separated by periods, and regions end with
+        // a brace
+        string str() const;
+
+        // Like str() but the same for any two positions that only differ in
+        // how the vertices are numbered, the order of the regions and
+        // boundaries, where each boundary starts, or by being mirror images.
+        // Positions with the same key play the same.
+        string key() const;
+
+    private:
+        void simplify(); // Drop dead vertices and regions with no moves left
+        Position sorted() const; // Same position in a standard order
+        void arranged(const vector<int>& count, bool mirror, string& best) const; // For key()
+};
+
+ostream& operator<<(ostream&, const Position&);
+
+#endif
@@ -0,0 +1,76 @@
+#ifndef H_SEGMENTS
+#define H_SEGMENTS
+
+#include <vector>
+#include "structs.h"
+
+using namespace std;
+
+// The segments of a set of lines, for checking whether a new segment would
+// cross any of them. Lines only go up, down, left, or right, so horizontal and
+// vertical segments are kept apart, each as separate arrays of where it is on
+// one axis and where it starts and ends on the other. Checking a segment is
+// then a loop over the ones going the other way and the ones on the same line
+// with no branches in it, which the compiler can vectorize.
+//
+// Once there are enough segments that looking at all of them gets slow, they
+// are also put into buckets by the squares of a grid they go through, and only
+// the buckets of the squares the new segment goes through are checked. There's
+// a fixed number of buckets, so squares far apart can share one, which only
+// means a few more segments get checked.
+//
+// A segment that's only a point is kept as both, since it's on both axes.
+class Segments
+{
+    // Segments going one way, at pos[i] on one axis from from[i] to to[i] on
+    // the other, from <= to
+    struct Arrays
+    {
+        vector<int> pos, from, to;
+
+        void add(int p, int f, int t);
+        void clear();
+    };
+
+    struct Bucket
+    {
+        Arrays horizontal;
+        Arrays vertical;
+    };
+
+    Arrays horizontal; // All of them, with pos the y and from/to the x
+    Arrays vertical;   // With pos the x and from/to the y
+    vector<Bucket> buckets; // Empty until there are enough segments
+
+    void index(); // Put all the segments into buckets
+    void index(int pos, int from, int to, bool isVertical);
+    Bucket& bucket(int x, int y); // For the square at x, y in squares
+    const Bucket& bucket(int x, int y) const;
+
+    // Whether any of the segments going the other way cross the new one at at
+    // on their axis, between lo and hi on its own, and whether any on the same
+    // line overlap it
+    static bool across(const Arrays&, int at, int lo, int hi);
+    static bool along(const Arrays&, int at, int lo, int hi);
+
+    public:
+        Segments() { }
+
+        // The segments between the first so many points of a line
+        Segments(const Line&, int points);
+
+        void clear();
+        void add(const Line&); // All its segments
+        void add(Coord a, Coord b);
+
+        // Whether the segment from a to b crosses any of these, runs along
+        // part of one, or, if it's a point, is inside one. Ending on a segment
+        // doesn't count unless touch is true. Either way, segments only
+        // touching the new one at their ends don't count, since that's where
+        // lines meet nodes.
+        bool crosses(Coord a, Coord b, bool touch = false) const;
+
+        int size() const { return horizontal.pos.size() + vertical.pos.size(); }
+};
+
+#endif
@@ -0,0 +1,118 @@
+/*
+ * Game tree search on abstract positions. Whoever can't move loses, so a
+ * position is either won or lost for the player to move. This searches with
+ * negamax and alpha-beta pruning, going deeper each time until it knows the
+ * answer or runs out of time. Positions deeper than it had time for count as
+ * unknown, which is between a win and a loss.
+ *
+ * Results are kept in a transposition table between searches. Its entries are
+ * found by a Zobrist hash of Position::key(), so the same position reached by
+ * moves in a different order, or with different vertex numbers, is only
+ * searched once. Each entry keeps the whole key, so two positions that happen
+ * to hash the same never share a result.
+ *
+ * Later in a game the regions often come apart into groups that don't share
+ * any vertices. Those are separate games played side by side, so only the
+ * biggest is searched and each of the others counts as a nim heap of its
+ * nimber (Sprague-Grundy theory), which is worked out once and remembered.
+ *
+ * The first few moves of games with more spots can take much longer to work
+ * out than a move is given, so the positions the winner needs to leave then
+ * are in a book made ahead of time.
+ */
+#ifndef H_Solver
+#define H_Solver
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+#include <iostream>
+#include "position.h"
+
+using namespace std;
+
+class Solver
+{
+    // What's known about a position from searching it to some depth. The
+    // value is a bound if the search was cut off by alpha-beta.
+    struct Entry
+    {
+        string key; // Of the position, empty if there's nothing here yet
+        int heap;
+        int depth;  // Proven wins and losses hold for any depth
+        int best;  // Index of the best move tried
+        signed char value;
+        signed char bound;
+    };
+
+    vector<Entry> table;
+    map<string, int> nimbers; // By each part's key
+    int milliseconds;
+    double deadline; // On the wall clock, zero for none
+    bool useBook;
+
+    // Keys of positions the player to move loses that take too long to work
+    // out during a game, ending with NULL. They're found by the book tool,
+    // which writes book.cpp.
+    static const char* const book[];
+
+    // Statistics of the last search
+    long nodes;
+    double seconds;
+    int finished; // Deepest search that was completed
+    int result;
+
+    public:
+        // Search for up to so many milliseconds each move, keeping 2^tableBits
+        // positions in the transposition table, and with the positions in the
+        // book already known unless told not to
+        Solver(int milliseconds = 1000, int tableBits = 18, bool useBook = true);
+
+        // The moves from this position with the best ones first, and whether
+        // the player to move wins (1), loses (-1), or it isn't known yet (0)
+        vector<AbstractMove> rank(const Position&);
+
+        // The same leaving out moves to positions with these keys, for when
+        // some moves can't be played
+        vector<AbstractMove> rank(const Position&, const set<string>& leaving);
+        int value() const { return result; }
+
+        long nodesSearched() const { return nodes; }
+        double nodesPerSecond() const;
+        int depth() const { return finished; }
+
+        // The nimber (Grundy value) of a position, the XOR of the nimbers of
+        // its parts. The player to move loses exactly when it's zero.
+        int nimber(const Position&);
+
+    private:
+        int partNimber(const Position&, const string& key);
+
+        // The value of a position played next to a nim heap of some size,
+        // where a move is either one in the position or taking any amount off
+        // the heap. The key is the position's.
+        int search(const Position&, int heap, const string& key, int depth, int alpha, int beta);
+
+        bool inBook(const string& key) const;
+
+        // The entry for a position and heap, or NULL if it isn't in the table
+        const Entry* find(const string& key, int heap) const;
+        Entry& slot(const string& key, int heap);
+        void store(const string& key, int heap, int depth, int best, int value, int alpha, int beta);
+
+        // The moves from a position, the positions after them, and their
+        // keys, leaving out moves that give the same position as an earlier
+        // one
+        void children(const Position&, vector<AbstractMove>& moves,
+            vector<Position>& positions, vector<string>& keys) const;
+};
+
+// Milliseconds on the wall clock since some fixed time. Unlike clock(), this
+// counts the time the player waits even while the program isn't running.
+double wallClock();
+
+// Something like "depth 12, 34567 nodes, 123456 nodes/s, win"
+ostream& operator<<(ostream&, const Solver&);
+
+#endif
@@ -1,19 +1,35 @@
+#include <algorithm>
 #include "headers/image.h"
+#include "headers/pack.h"
 
-Image::Image(const string& s, bool transparent)
+SDL_Surface* Image::load(const string& s)
 {
-    SDL_Surface* tmpImg = IMG_Load(s.c_str());
+    // Decoding it is the slow part, so use the pack if it's in there
+    SDL_Surface* tmpImg = Pack::assets().surface(s);
+
+    if (!tmpImg)
+        tmpImg = IMG_Load(s.c_str());
 
     if (!tmpImg)
         throw ImageNotLoaded(s);
 
     // Optimize image for depth of screen
-    img = SDL_DisplayFormat(tmpImg);
+    SDL_Surface* img = SDL_DisplayFormat(tmpImg);
     SDL_FreeSurface(tmpImg);
 
     if (!img)
         throw ImageNotLoaded(s);
 
+    return img;
+}
+
+Image::Image(const string& s, bool transparent)
+    :img(load(s))
+{
+    at.x = at.y = 0;
+    at.w = img->w;
+    at.h = img->h;
+
     // Enable transparency
     if (transparent)
     {
@@ -22,11 +38,69 @@ Image::Image(const string& s, bool transparent)
     }
 }
 
+Image::Image(const string& s, Image& base)
+    :img(load(s))
+{
+    at.x = at.y = 0;
+    at.w = img->w;
+    at.h = img->h;
+
+    // Keep all of it if it's not like base or is the same
+    SDL_Rect changed;
+
+    if (!Damage::difference(img, base.img, changed) || changed.w == 0)
+        return;
+
+    SDL_Surface* part = SDL_CreateRGBSurface(SDL_SWSURFACE, changed.w, changed.h,
+        img->format->BitsPerPixel, img->format->Rmask, img->format->Gmask,
+        img->format->Bmask, img->format->Amask);
+
+    if (!part)
+        return;
+
+    SDL_Rect from = changed;
+    SDL_BlitSurface(img, &from, part, NULL);
+    SDL_FreeSurface(img);
+
+    img = part;
+    at = changed;
+}
+
 SDL_Surface* Image::surface()
 {
     return img;
 }
 
+void Image::draw(SDL_Surface* target, const SDL_Rect* part)
+{
+    SDL_Rect from;
+    SDL_Rect to = at;
+
+    if (part)
+    {
+        // Where the part is on the image, cut to fit on it
+        const int left = max<int>(part->x, at.x);
+        const int top = max<int>(part->y, at.y);
+        const int right = min<int>(part->x + part->w, at.x + at.w);
+        const int bottom = min<int>(part->y + part->h, at.y + at.h);
+
+        if (left >= right || top >= bottom)
+            return;
+
+        to.x = left;
+        to.y = top;
+        to.w = right - left;
+        to.h = bottom - top;
+    }
+
+    from.x = to.x - at.x;
+    from.y = to.y - at.y;
+    from.w = to.w;
+    from.h = to.h;
+
+    SDL_BlitSurface(img, &from, target, &to);
+}
+
 Image::~Image()
 {
     SDL_FreeSurface(img);
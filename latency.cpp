@@ -0,0 +1,94 @@
+/*
+*   Timing how long input takes to show up on the screen
+*/
+#include <iomanip>
+#include <sstream>
+#include "headers/latency.h"
+
+// What to call each type of event in the table
+static string name(int type)
+{
+    switch (type)
+    {
+        case SDL_MOUSEMOTION:     return "mouse motion";
+        case SDL_MOUSEBUTTONDOWN: return "button down";
+        case SDL_MOUSEBUTTONUP:   return "button up";
+        case SDL_KEYDOWN:         return "key down";
+        case SDL_KEYUP:           return "key up";
+        case SDL_ACTIVEEVENT:     return "focus";
+        case SDL_VIDEOEXPOSE:     return "expose";
+        case SDL_QUIT:            return "quit";
+    }
+
+    ostringstream s;
+    s << "event " << type;
+    return s.str();
+}
+
+Latency::Latency()
+    :counts(SDL_NUMEVENTS, vector<int>(buckets, 0)), merged(0)
+{
+}
+
+void Latency::add(Uint8 type, Uint32 ms)
+{
+    if (type < counts.size())
+        ++counts[type][bucket(ms)];
+}
+
+int Latency::bucket(Uint32 ms)
+{
+    int b = 0;
+
+    while (ms > 0 && b < buckets - 1)
+    {
+        ms /= 2;
+        ++b;
+    }
+
+    return b;
+}
+
+void Latency::print(ostream& os) const
+{
+    os << "Input latency in ms, from taking an event off the queue to showing it" << endl
+       << setw(14) << left << "event" << right << setw(8) << "count";
+
+    for (int b = 0; b < buckets; b++)
+    {
+        ostringstream label;
+
+        if (b == 0)
+            label << "<1";
+        else if (b == 1)
+            label << "1";
+        else if (b == buckets - 1)
+            label << (1 << (b - 1)) << "+";
+        else
+            label << (1 << (b - 1)) << "-" << (1 << b) - 1;
+
+        os << setw(8) << label.str();
+    }
+
+    os << endl;
+
+    for (int type = 0; type < counts.size(); type++)
+    {
+        int total = 0;
+
+        for (int b = 0; b < buckets; b++)
+            total += counts[type][b];
+
+        if (total == 0)
+            continue;
+
+        os << setw(14) << left << name(type) << right << setw(8) << total;
+
+        for (int b = 0; b < buckets; b++)
+            os << setw(8) << counts[type][b];
+
+        os << endl;
+    }
+
+    os << merged << " mouse motion events skipped for a later one" << endl;
+}
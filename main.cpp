@@ -7,6 +7,7 @@
 #include "headers/menu.h"
 #include "headers/image.h"
 #include "headers/gamegui.h"
+#include "headers/latency.h"
 
 int main(int argc, char *argv[])
 {
@@ -16,6 +17,23 @@ int main(int argc, char *argv[])
 	bool gameRunning = true;
 	SDL_Event event;	// dump event polls into this
 
+    // With --latency, print how long input took to show up when exiting
+    bool timeInput = false;
+    Latency latency;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (string(argv[i]) == "--latency")
+        {
+            timeInput = true;
+        }
+        else
+        {
+            fprintf(stderr, "Usage: %s [--latency]\n", argv[0]);
+            return 1;
+        }
+    }
+
     // Initialize SDL, NOPARACHUTE means SDL will handle fatal interrupts which
     // we use to exit on Ctrl+C.
 	if (SDL_Init(SDL_INIT_VIDEO | SDL_INIT_NOPARACHUTE) < 0)
@@ -63,126 +81,157 @@ int main(int argc, char *argv[])
         menu.init();
         GameGUI game(screen, font);
 
+        bool loading = true; // Menu images left to load while nothing's happening
+
         while (gameRunning)
         {
-            while (gameRunning && SDL_PollEvent(&event))
+            // Wait for something to happen, unless there's loading to do
+            // in the meantime
+            if (loading && !SDL_PollEvent(&event))
+            {
+                loading = menu.loadNext();
+                continue;
+            }
+            else if (!loading && !SDL_WaitEvent(&event))
+            {
+                fprintf(stderr, "SDL_WaitEvent: %s\n", SDL_GetError());
+                break;
+            }
+
+            const Uint32 start = SDL_GetTicks();
+
+            // Only where the mouse is now matters, so skip to the last of the
+            // motion events at the front of the queue instead of drawing for
+            // each one
+            if (event.type == SDL_MOUSEMOTION)
+            {
+                SDL_Event next;
+                SDL_PumpEvents();
+
+                while (SDL_PeepEvents(&next, 1, SDL_PEEKEVENT, SDL_ALLEVENTS) == 1 &&
+                       next.type == SDL_MOUSEMOTION &&
+                       SDL_PeepEvents(&next, 1, SDL_GETEVENT, SDL_MOUSEMOTIONMASK) == 1)
+                {
+                    event = next;
+                    latency.skipped(1);
+                }
+            }
+
+            try
             {
-                try
+                switch (event.type)
                 {
-                    switch (event.type)
-                    {
-                        case SDL_QUIT: // Alt+F4, X, ...
-                            gameRunning = false;
-                            break;
-                        case SDL_ACTIVEEVENT:
-                            break;
-                        case SDL_KEYDOWN:
-                            break;
-                        case SDL_KEYUP:
-                            // Escape cancels line and does nothing (at the moment) in the menu
-                            if (event.key.keysym.sym == SDLK_ESCAPE)
-                            {
-                                if (inMenu)
-                                    menu.cancel();
-                                else
-                                    game.cancel();
-                            }
-                            // Q returns to menu
-                            else if (event.key.keysym.sym == SDLK_q && !inMenu)
-                            {
-                                game = GameGUI(screen, font);
-                                inMenu = true;
-                                menu.init();
-                            }
-                            break;
-                        case SDL_MOUSEBUTTONDOWN:
-                            break;
-                        case SDL_MOUSEBUTTONUP:
-                            if (event.button.button == SDL_BUTTON_LEFT)
+                    case SDL_QUIT: // Alt+F4, X, ...
+                        gameRunning = false;
+                        break;
+                    case SDL_ACTIVEEVENT:
+                        break;
+                    case SDL_KEYDOWN:
+                        break;
+                    case SDL_KEYUP:
+                        // Escape cancels line and does nothing (at the moment) in the menu
+                        if (event.key.keysym.sym == SDLK_ESCAPE)
+                        {
+                            if (inMenu)
+                                menu.cancel();
+                            else
+                                game.cancel();
+                        }
+                        // Q returns to menu
+                        else if (event.key.keysym.sym == SDLK_q && !inMenu)
+                        {
+                            game = GameGUI(screen, font);
+                            inMenu = true;
+                            menu.init();
+                        }
+                        break;
+                    case SDL_MOUSEBUTTONDOWN:
+                        break;
+                    case SDL_MOUSEBUTTONUP:
+                        if (event.button.button == SDL_BUTTON_LEFT)
+                        {
+                            // If it's in the menu, send the click event and
+                            // then see if they clicked to start the game. If
+                            // so, switch to game mode by setting inMenu to
+                            // false and draw the game with the specified
+                            // number of nodes to the screen.
+                            if (inMenu)
                             {
-                                // If it's in the menu, send the click event and
-                                // then see if they clicked to start the game. If
-                                // so, switch to game mode by setting inMenu to
-                                // false and draw the game with the specified
-                                // number of nodes to the screen.
-                                if (inMenu)
+                                ClickType status = menu.click(Coord(event.button.x, event.button.y));
+
+                                // Exit the program.
+                                if (status == EXIT)
                                 {
-                                    ClickType status = menu.click(Coord(event.button.x, event.button.y));
-
-                                    // Exit the program.
-                                    if (status == EXIT)
-                                    {
-                                        gameRunning = false;
-                                    }
-                                    // Start the game with the specified number of nodes
-                                    else if (status == GAME)
-                                    {
-                                        inMenu = false;
-                                        game.init(menu.mode(), menu.nodes(), menu.nodeRadius(), menu.lineThick());
-                                    }
+                                    gameRunning = false;
                                 }
-                                else
+                                // Start the game with the specified number of nodes
+                                else if (status == GAME)
                                 {
-                                    State state = game.click(Coord(event.button.x, event.button.y));
-
-                                    if (state == GameEnd)
-                                    {
-                                        //cout << "Game has ended!" << endl;
-                                        SDL_Delay(200);
-                                        inMenu = true;
-                                        menu.over(game.playerTurn());
-                                        game = GameGUI(screen, font);
-                                    }
+                                    inMenu = false;
+                                    game.init(menu.mode(), menu.nodes(), menu.nodeRadius(), menu.lineThick());
                                 }
                             }
-                            break;
-                        case SDL_MOUSEMOTION:
-                            if (inMenu)
-                                menu.cursor(Coord(event.motion.x, event.motion.y));
                             else
-                                game.cursor(Coord(event.motion.x, event.motion.y));
-                            break;
-                        default:
-                            break;
-                    }
-                }
-                // Catch all of the errors that might have occurred in the game. If
-                // these are thrown, there's a GUI problem since the GUI shouldn't
-                // allow invalid moves. That, or the A-Checker has a bug that saying
-                // a move is invalid when it shouldn't be.
-                catch (const InvalidLine& e)
-                {
-                    cout << "Error: Tried to add an invalid line. " << e << endl;
-                }
-                catch (const InvalidNode& e)
-                {
-                    cout << "Error: Could not find start and/or end node in the line" << endl;
-                }
-                catch (const InvalidMiddle& e)
-                {
-                    cout << "Error: Could not find where to place middle node in the line. " << e << endl;
-                }
-                catch (const AreasOutdated& e)
-                {
-                    cout << "Error: Tried to find if connectable with outdated areas" << endl;
-                }
-                catch (const InvalidCorner& e)
-                {
-                    cout << "Error: Tried to add a middle node on a corner" << endl;
-                }
-                catch (const NodeEntryCollision& e)
-                {
-                    cout << "Error: Tried to enter a node twice from the same direction" << endl;
-                }
-                // Note that NotConnectable is only thrown when Game game(true), setting extraChecks to true
-                catch (const NotConnectable& e)
-                {
-                    cout << "Error: Tried to connect two nodes that shouldn't be connectable" << endl;
+                            {
+                                State state = game.click(Coord(event.button.x, event.button.y));
+
+                                if (state == GameEnd)
+                                {
+                                    //cout << "Game has ended!" << endl;
+                                    SDL_Delay(200);
+                                    inMenu = true;
+                                    menu.over(game.playerTurn());
+                                    game = GameGUI(screen, font);
+                                }
+                            }
+                        }
+                        break;
+                    case SDL_MOUSEMOTION:
+                        if (inMenu)
+                            menu.cursor(Coord(event.motion.x, event.motion.y));
+                        else
+                            game.cursor(Coord(event.motion.x, event.motion.y));
+                        break;
+                    default:
+                        break;
                 }
             }
+            // Catch all of the errors that might have occurred in the game. If
+            // these are thrown, there's a GUI problem since the GUI shouldn't
+            // allow invalid moves. That, or the A-Checker has a bug that saying
+            // a move is invalid when it shouldn't be.
+            catch (const InvalidLine& e)
+            {
+                cout << "Error: Tried to add an invalid line. " << e << endl;
+            }
+            catch (const InvalidNode& e)
+            {
+                cout << "Error: Could not find start and/or end node in the line" << endl;
+            }
+            catch (const InvalidMiddle& e)
+            {
+                cout << "Error: Could not find where to place middle node in the line. " << e << endl;
+            }
+            catch (const AreasOutdated& e)
+            {
+                cout << "Error: Tried to find if connectable with outdated areas" << endl;
+            }
+            catch (const InvalidCorner& e)
+            {
+                cout << "Error: Tried to add a middle node on a corner" << endl;
+            }
+            catch (const NodeEntryCollision& e)
+            {
+                cout << "Error: Tried to enter a node twice from the same direction" << endl;
+            }
+            // Note that NotConnectable is only thrown when Game game(true), setting extraChecks to true
+            catch (const NotConnectable& e)
+            {
+                cout << "Error: Tried to connect two nodes that shouldn't be connectable" << endl;
+            }
 
-            // Don't use all the CPU
-            SDL_Delay(20);
+            if (timeInput)
+                latency.add(event.type, SDL_GetTicks() - start);
         }
     }
     catch (const ImageNotLoaded& e)
@@ -194,6 +243,9 @@ int main(int argc, char *argv[])
         cout << "Error: Unhandled Exception" << endl;
     }
 
+    if (timeInput)
+        latency.print(cout);
+
     TTF_CloseFont(font);
     SDL_FreeSurface(screen);
     SDL_Quit();
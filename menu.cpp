@@ -1,7 +1,134 @@
 // This is a very basic menu system which could stand for a lot of improvement
 
+#include <climits>
 #include "headers/menu.h"
 
+// A button on a page: where the cursor highlights it, from left to right and
+// top to bottom not including right and bottom, and the image of the page with
+// it highlighted
+struct Button
+{
+    int left, top, right, bottom;
+    const char* highlight;
+};
+
+// The buttons on the main menu go all the way across
+static const Button mainButtons[] =
+{
+    { 0, 250, INT_MAX, 300, "images/StartHover.jpg" },
+    { 0, 300, INT_MAX, 350, "images/OptionsHover.jpg" },
+    { 0, 350, INT_MAX, 400, "images/InstructionsHover.jpg" },
+    { 0, 400, INT_MAX, 450, "images/CreditsHover.jpg" },
+    { 0, 450, INT_MAX, 501, "images/ExitHover.jpg" }
+};
+
+static const Button optionsButtons[] =
+{
+    { 345, 200, 460, 260, "images/optionsSmallNodeHover.jpg" },
+    { 460, 200, 600, 260, "images/optionsMediumNodeHover.jpg" },
+    { 600, 200, 700, 260, "images/optionsLargeNodeHover.jpg" },
+    { 345, 260, 460, 330, "images/optionsSmallLineHover.jpg" },
+    { 460, 260, 600, 330, "images/optionsMediumLineHover.jpg" },
+    { 600, 260, 700, 330, "images/optionsLargeLineHover.jpg" },
+    { 345, 330, 395, 400, "images/optionsThreeNodesHover.jpg" },
+    { 395, 330, 440, 400, "images/optionsFourNodesHover.jpg" },
+    { 440, 330, 485, 400, "images/optionsFiveNodesHover.jpg" },
+    { 485, 330, 520, 400, "images/optionsSixNodesHover.jpg" },
+    { 520, 330, 565, 400, "images/optionsSevenNodesHover.jpg" },
+    { 345, 400, 540, 450, "images/optionsPvPHover.jpg" },
+    { 540, 400, 701, 450, "images/optionsPvAIHover.jpg" },
+    { 345, 510, 450, 576, "images/optionsBackHover.jpg" }
+};
+
+static const Button instructionsButtons[] =
+{
+    { 0, 550, INT_MAX, INT_MAX, "images/InstructionsBackHover.jpg" }
+};
+
+static const Button creditsButtons[] =
+{
+    { 0, 550, INT_MAX, INT_MAX, "images/CreditsBackHover.jpg" }
+};
+
+static const Button computerWinsButtons[] =
+{
+    { 0, 390, INT_MAX, 440, "images/ComputerWinsMenuHover.jpg" },
+    { 0, 440, INT_MAX, 491, "images/ComputerWinsExitHover.jpg" }
+};
+
+static const Button playerOneWinsButtons[] =
+{
+    { 0, 390, INT_MAX, 440, "images/PlayerOneWinsMenuHover.jpg" },
+    { 0, 440, INT_MAX, 491, "images/PlayerOneWinsExitHover.jpg" }
+};
+
+static const Button playerTwoWinsButtons[] =
+{
+    { 0, 390, INT_MAX, 440, "images/PlayerTwoWinsMenuHover.jpg" },
+    { 0, 440, INT_MAX, 491, "images/PlayerTwoWinsExitHover.jpg" }
+};
+
+#define BUTTONS(b) b, sizeof(b)/sizeof(b[0])
+
+Page::Page(const string& s, const Button* buttons, int count)
+    :file(s), background(NULL), buttons(buttons), highlights(count, (Image*)NULL)
+{
+}
+
+Image& Page::image()
+{
+    if (!background)
+        background = new Image(file);
+
+    return *background;
+}
+
+Image& Page::highlight(int button)
+{
+    if (!highlights[button])
+        highlights[button] = new Image(buttons[button].highlight, image());
+
+    return *highlights[button];
+}
+
+Image* Page::highlight(Coord location)
+{
+    for (int i = 0; i < highlights.size(); i++)
+        if (location.x >= buttons[i].left && location.x < buttons[i].right &&
+            location.y >= buttons[i].top && location.y < buttons[i].bottom)
+            return &highlight(i);
+
+    return NULL;
+}
+
+bool Page::loadNext()
+{
+    if (!background)
+    {
+        image();
+        return true;
+    }
+
+    for (int i = 0; i < highlights.size(); i++)
+    {
+        if (!highlights[i])
+        {
+            highlight(i);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+Page::~Page()
+{
+    delete background;
+
+    for (int i = 0; i < highlights.size(); i++)
+        delete highlights[i];
+}
+
 Menu::Menu(SDL_Surface* screen)
 : screen(screen),
 optionsNodeRadius(5), // the drawn node radius is set to 5 by default
@@ -9,45 +136,14 @@ optionsLineThick(1), // the line thickness is set to 1 by default
 playerMode(PvP), // the player mode is set to two player by default
 numberOfNodes(3), // the number of nodes is set to 3 by default
 
-// the following lines of code load the images to the appropriate Image class variables
-sproutsMenu("images/SproutsMenu.jpg"),
-startHover("images/StartHover.jpg"),
-optionsHover("images/OptionsHover.jpg"),
-instructionsHover("images/InstructionsHover.jpg"),
-creditsHover("images/CreditsHover.jpg"),
-exitHover("images/ExitHover.jpg"),
-
-options("images/Options.jpg"),
-optionsSmallNodeHover("images/optionsSmallNodeHover.jpg"),
-optionsMediumNodeHover("images/optionsMediumNodeHover.jpg"),
-optionsLargeNodeHover("images/optionsLargeNodeHover.jpg"),
-optionsSmallLineHover("images/optionsSmallLineHover.jpg"),
-optionsMediumLineHover("images/optionsMediumLineHover.jpg"),
-optionsLargeLineHover("images/optionsLargeLineHover.jpg"),
-optionsThreeNodesHover("images/optionsThreeNodesHover.jpg"),
-optionsFourNodesHover("images/optionsFourNodesHover.jpg"),
-optionsFiveNodesHover("images/optionsFiveNodesHover.jpg"),
-optionsSixNodesHover("images/optionsSixNodesHover.jpg"),
-optionsSevenNodesHover("images/optionsSevenNodesHover.jpg"),
-optionsPvPHover("images/optionsPvPHover.jpg"),
-optionsPvAIHover("images/optionsPvAIHover.jpg"),
-optionsBackHover("images/optionsBackHover.jpg"),
-
-instructions("images/Instructions.jpg"),
-instructionsBackHover("images/InstructionsBackHover.jpg"),
-
-credits("images/Credits.jpg"),
-creditsBackHover("images/CreditsBackHover.jpg"),
-
-computerWins("images/ComputerWins.jpg"),
-computerWinsExitHover("images/ComputerWinsExitHover.jpg"),
-computerWinsMenuHover("images/ComputerWinsMenuHover.jpg"),
-playerOneWins("images/PlayerOneWins.jpg"),
-playerOneWinsExitHover("images/PlayerOneWinsExitHover.jpg"),
-playerOneWinsMenuHover("images/PlayerOneWinsMenuHover.jpg"),
-playerTwoWins("images/PlayerTwoWins.jpg"),
-playerTwoWinsExitHover("images/PlayerTwoWinsExitHover.jpg"),
-playerTwoWinsMenuHover("images/PlayerTwoWinsMenuHover.jpg"),
+// the following lines of code say where the pages and the buttons on them are, which are loaded when they're first shown
+sproutsMenu("images/SproutsMenu.jpg", BUTTONS(mainButtons)),
+options("images/Options.jpg", BUTTONS(optionsButtons)),
+instructions("images/Instructions.jpg", BUTTONS(instructionsButtons)),
+credits("images/Credits.jpg", BUTTONS(creditsButtons)),
+computerWins("images/ComputerWins.jpg", BUTTONS(computerWinsButtons)),
+playerOneWins("images/PlayerOneWins.jpg", BUTTONS(playerOneWinsButtons)),
+playerTwoWins("images/PlayerTwoWins.jpg", BUTTONS(playerTwoWinsButtons)),
 
 // different pages are shown based on which variable is flipped to true
 GameStart(false),
@@ -58,38 +154,88 @@ GameExit(false),
 GameOver(false),
 p1Wins(false),
 p2Wins(false),
-aiWins(false)
+aiWins(false),
+shown(NULL),
+highlighted(NULL)
 {
-    fill(&check[0], &check[0]+37, false);
 }
 
-// the following function is used to change the look of the screen and to flip a bool which prevents it being flipped again unnecessarily
-void Menu::menuFlip(SDL_Surface* img, bool& check)
+// the following function is used to change the look of the screen. If it's
+// the same page, only the buttons that were or are now highlighted change.
+void Menu::show(Page& page, Image* highlight)
 {
-    SDL_BlitSurface(img, NULL, screen, NULL);
-    SDL_Flip(screen);
-    check = true;
+    if (&page == shown && highlight == highlighted)
+        return;
+
+    if (&page != shown || !Damage::partial(screen))
+    {
+        page.image().draw(screen);
+        damage.addAll();
+
+        if (highlight)
+            highlight->draw(screen);
+    }
+    else
+    {
+        if (highlighted)
+        {
+            page.image().draw(screen, &highlighted->area());
+            damage.add(highlighted->area());
+        }
+
+        if (highlight)
+        {
+            highlight->draw(screen);
+            damage.add(highlight->area());
+        }
+    }
+
+    shown = &page;
+    highlighted = highlight;
+    damage.present(screen);
+}
+
+// the pages are loaded in about the order they're likely to be needed
+bool Menu::loadNext()
+{
+    return sproutsMenu.loadNext() || options.loadNext() || instructions.loadNext() ||
+           credits.loadNext() || playerOneWins.loadNext() || playerTwoWins.loadNext() ||
+           computerWins.loadNext();
 }
 
 // the following function makes the background the main menu
 void Menu::init()
 {
-    menuFlip(sproutsMenu.surface(), check[1]);
+    shown = NULL; // the game was on the screen
+    show(sproutsMenu);
 }
 
 // the following function tells the rest of the menu that the game is over and tells it which game over page to display
 void Menu::over(bool player1lost)
 {
     GameOver = true;
+    shown = NULL; // the game was on the screen
     if (player1lost == false)
-        menuFlip(playerOneWins.surface(), p1Wins);
+        p1Wins = true;
     else
     {
         if (playerMode == PvP)
-            menuFlip(playerTwoWins.surface(), p2Wins);
+            p2Wins = true;
         else
-            menuFlip(computerWins.surface(), aiWins);
+            aiWins = true;
     }
+    show(overPage());
+}
+
+// a system that shows who won the game based on the bool that is flipped to true based on who moved last
+Page& Menu::overPage()
+{
+    if (p1Wins == true)
+        return playerOneWins;
+    else if (p2Wins == true)
+        return playerTwoWins;
+    else
+        return computerWins;
 }
 
 // the following function tells the program whether it should should call the main menu or game over menu
@@ -105,497 +251,23 @@ void Menu::cursor(Coord location)
 void Menu::cursorMenu(Coord location)
 {
     if (GameOptions == true) // the options button is clicked on calling the options page
-    {
         optionsPageCursor(location);
-    }
-    else
-    {
-        if (GameInstructions == true)// the instructions button is clicked on calling the options page
-        {
-            if ( location.y < 550 ) // the back button is not highlighted
-            {
-                if (!check[9]) // the check is false then the backgrond is switched and the check is made true so the background won't change again until
-                               // the mouse is moved over or away from another button
-                {
-                    check[10] = false;
-                    menuFlip(instructions.surface(), check[9]);
-                }
-            }
-            else // the back button is highlighted
-            {
-                if (!check[10])
-                {
-                    check[9] = false;
-                    menuFlip(instructionsBackHover.surface(), check[10]);
-                }
-            }
-        }
-        else
-        {
-            if (GameCredits == true) // the credits button is clicked on calling the credits page
-            {
-                if ( location.y < 550 ) // the back button is not highlighted
-                {
-                    if (!check[11])
-                    {
-                        check[12] = false;
-                        menuFlip(credits.surface(), check[11]);
-                    }
-                }
-                else // the back button is highlighted
-                {
-                    if (!check[12])
-                    {
-                        check[11] = false;
-                        menuFlip(creditsBackHover.surface(), check[12]);
-                    }
-                }
-            }
-            else // you are simply moving the mouse around the main menu page
-            {
-                if ( (location.y < 250) || (location.y > 500) ) // if the mouse coordinates fit this description then no buttons are highlighted
-                {
-                    if (!check[1])
-                    {
-                        for (int i=1; i<=6; i++)
-                        {
-                            check[i] = false;
-                        }
-                        menuFlip(sproutsMenu.surface(), check[1]); // no buttons are highlighted
-                    }
-                }
-                else
-                {
-                    if ( location.y < 300 )
-                    {
-                        if (!check[2])
-                        {
-                            for (int i=1; i<=6; i++)
-                            {
-                                check[i] = false;
-                            }
-                            menuFlip(startHover.surface(), check[2]); // the start button is highlighted
-                        }
-                    }
-                    else
-                    {
-                        if ( location.y < 350 )
-                        {
-                            if (!check[3])
-                            {
-                                for (int i=1; i<=6; i++)
-                                {
-                                    check[i] = false;
-                                }
-                                menuFlip(optionsHover.surface(), check[3]); // the options button is highlighted
-                            }
-                        }
-                        else
-                        {
-                            if ( location.y < 400 )
-                            {
-                                if (!check[4])
-                                {
-                                    for (int i=1; i<=6; i++)
-                                    {
-                                        check[i] = false;
-                                    }
-                                    menuFlip(instructionsHover.surface(), check[4]); // the instructions button is highlighted
-                                }
-                            }
-                            else
-                            {
-                                if ( location.y < 450 )
-                                {
-                                    if (!check[5])
-                                    {
-                                        for (int i=1; i<=6; i++)
-                                        {
-                                            check[i] = false;
-                                        }
-                                        menuFlip(creditsHover.surface(), check[5]); // the credits button is highlighted
-                                    }
-                                }
-                                else
-                                {
-                                    if (!check[6])
-                                    {
-                                        for (int i=1; i<=6; i++)
-                                        {
-                                            check[i] = false;
-                                        }
-                                        menuFlip(exitHover.surface(), check[6]); // the exit button is highlighted
-                                    }
-                                }
-                            }
-                        }
-                    }
-                }
-            }
-        }
-    }
+    else if (GameInstructions == true) // the instructions button is clicked on calling the instructions page
+        show(instructions, instructions.highlight(location));
+    else if (GameCredits == true) // the credits button is clicked on calling the credits page
+        show(credits, credits.highlight(location));
+    else // you are simply moving the mouse around the main menu page
+        show(sproutsMenu, sproutsMenu.highlight(location));
 }
 
 void Menu::cursorGameOver(Coord location)
 {
-    if (p1Wins == true) // a system that shows who won the game based on the bool that is flipped to true based on who moved last
-    {
-        if ( (location.y < 390) || (location.y > 490) )
-        {
-            if (!check[13])
-            {
-                check[14] = check[15] = false;
-                menuFlip(playerOneWins.surface(), check[13]); // no buttons are highlighted
-            }
-        }
-        else
-        {
-            if ( location.y < 440 )
-            {
-                if (!check[14])
-                {
-                    check[13] = check[15] = false;
-                    menuFlip(playerOneWinsMenuHover.surface(), check[14]); // the menu button is highlighted
-                }
-            }
-            else
-            {
-                if ( location.y < 490 )
-                {
-                    if (!check[15])
-                    {
-                        check[13] = check[14] = false;
-                        menuFlip(playerOneWinsExitHover.surface(), check[15]); // the exit button is highlighted
-                    }
-                }
-            }
-        }
-    }
-    else
-    {
-        if (p2Wins == true)
-        {
-            if ( (location.y < 390) || (location.y > 490) )
-            {
-                if (!check[16])
-                {
-                    check[17] = check[18] = false;
-                    menuFlip(playerTwoWins.surface(), check[16]); // no button is highlighted
-                }
-            }
-            else
-            {
-                if ( location.y < 440 )
-                {
-                    if (!check[17])
-                    {
-                        check[16] = check[18] = false;
-                        menuFlip(playerTwoWinsMenuHover.surface(), check[17]); // the menu button is highlighted
-                    }
-                }
-                else
-                {
-                    if ( location.y < 490 )
-                    {
-                        if (!check[18])
-                        {
-                            check[16] = check[17] = false;
-                            menuFlip(playerTwoWinsExitHover.surface(), check[18]); // the exit button is highlighted
-                        }
-                    }
-                }
-            }
-        }
-        else
-        {
-            if ( (location.y < 390) || (location.y > 490) )
-            {
-                if (!check[19])
-                {
-                    check[20] = check[21] = false;
-                    menuFlip(computerWins.surface(), check[19]); // no button is highlighted
-                }
-            }
-            else
-            {
-                if ( location.y < 440 )
-                {
-                    if (!check[20])
-                    {
-                        check[19] = check[21] = false;
-                        menuFlip(computerWinsMenuHover.surface(), check[20]); // the menu button is highlighted
-                    }
-                }
-                else
-                {
-                    if ( location.y < 500 )
-                    {
-                        if (!check[21])
-                        {
-                            check[19] = check[20] = false;
-                            menuFlip(computerWinsExitHover.surface(), check[21]); // the exit button is highlighted
-                        }
-                    }
-                }
-            }
-        }
-    }
+    show(overPage(), overPage().highlight(location));
 }
 
 void Menu::optionsPageCursor(Coord location) // highlights the different buttons of the options page based on the mouse location
 {
-    if ( (location.y < 200) || (location.y > 575) || (location.x < 345) || (location.x > 700))
-    {
-        if (!check[22])
-        {
-            for (int i=22; i<=36; i++)
-            {
-                check[i] = false;
-            }
-            menuFlip(options.surface(), check[22]); // no button is highlighted
-        }
-    }
-    else
-    {
-        if ( location.y < 260 )
-        {
-            if (location.x < 460)
-            {
-                if (!check[23])
-                {
-                    for (int i=22; i<=36; i++)
-                    {
-                        check[i] = false;
-                    }
-                    menuFlip(optionsSmallNodeHover.surface(), check[23]); // the small node button is highlighted
-                }
-            }
-            else
-            {
-                if (location.x < 600)
-                {
-                    if (!check[24])
-                    {
-                        for (int i=22; i<=36; i++)
-                        {
-                            check[i] = false;
-                        }
-                        menuFlip(optionsMediumNodeHover.surface(), check[24]); // the medium node button is highlighted
-                    }
-                }
-                else
-                {
-                    if (location.x < 700)
-                    {
-                        if (!check[25])
-                        {
-                            for (int i=22; i<=36; i++)
-                            {
-                                check[i] = false;
-                            }
-                            menuFlip(optionsLargeNodeHover.surface(), check[25]); // the large node button is highlighted
-                        }
-                    }
-                }
-            }
-        }
-        else
-        {
-            if ( location.y < 330 )
-            {
-                if (location.x < 460)
-                {
-                    if (!check[26])
-                    {
-                        for (int i=22; i<=36; i++)
-                        {
-                            check[i] = false;
-                        }
-                        menuFlip(optionsSmallLineHover.surface(), check[26]); // the small line button is highlighted
-                    }
-                }
-                else
-                {
-                    if (location.x < 600)
-                    {
-                        if (!check[27])
-                        {
-                            for (int i=22; i<=36; i++)
-                            {
-                                check[i] = false;
-                            }
-                            menuFlip(optionsMediumLineHover.surface(), check[27]); // the medium line button is highlighted
-                        }
-                    }
-                    else
-                    {
-                        if (location.x < 700)
-                        {
-                            if (!check[28])
-                            {
-                                for (int i=22; i<=36; i++)
-                                {
-                                    check[i] = false;
-                                }
-                                menuFlip(optionsLargeLineHover.surface(), check[28]); // the large line button is highlighted
-                            }
-                        }
-                    }
-                }
-            }
-            else
-            {
-                if ( location.y < 400 )
-                {
-                    if (location.x < 395)
-                    {
-                        if (!check[29])
-                        {
-                            for (int i=22; i<=36; i++)
-                            {
-                                check[i] = false;
-                            }
-                            menuFlip(optionsThreeNodesHover.surface(), check[29]); // the three nodes button is highlighted
-                        }
-                    }
-                    else
-                    {
-                        if (location.x < 440)
-                        {
-                            if (!check[30])
-                            {
-                                for (int i=22; i<=36; i++)
-                                {
-                                    check[i] = false;
-                                }
-                                menuFlip(optionsFourNodesHover.surface(), check[30]); // the four nodes button is highlighted
-                            }
-                        }
-                        else
-                        {
-                            if (location.x < 485)
-                            {
-                                if (!check[31])
-                                {
-                                    for (int i=22; i<=36; i++)
-                                    {
-                                        check[i] = false;
-                                    }
-                                    menuFlip(optionsFiveNodesHover.surface(), check[31]); // the five nodes button is highlighted
-                                }
-                            }
-                            else
-                            {
-                                if (location.x < 520)
-                                {
-                                    if (!check[32])
-                                    {
-                                        for (int i=22; i<=36; i++)
-                                        {
-                                            check[i] = false;
-                                        }
-                                        menuFlip(optionsSixNodesHover.surface(), check[32]); // the six nodes button is highlighted
-                                    }
-                                }
-                                else
-                                {
-                                    if (location.x < 565)
-                                    {
-                                        if (!check[33])
-                                        {
-                                            for (int i=22; i<=36; i++)
-                                            {
-                                                check[i] = false;
-                                            }
-                                            menuFlip(optionsSevenNodesHover.surface(), check[33]); // the seven nodes button is highlighted
-                                        }
-                                    }
-                                    else
-                                    {
-                                        if (!check[22])
-                                        {
-                                            for (int i=22; i<=36; i++)
-                                            {
-                                                check[i] = false;
-                                            }
-                                            menuFlip(options.surface(), check[22]); // no buttons are highlighted if the mouse is too far right of the seven nodes button
-                                        }
-                                    }
-                                }
-                            }
-                        }
-                    }
-                }
-                else
-                {
-                    if (location.y < 450)
-                    {
-                        if (location.x < 540)
-                        {
-                            if (!check[34])
-                            {
-                                for (int i=22; i<=36; i++)
-                                {
-                                    check[i] = false;
-                                }
-                                menuFlip(optionsPvPHover.surface(), check[34]); // the two player game mode button is highlighted
-                            }
-                        }
-                        else
-                        {
-                            if (!check[35])
-                            {
-                                for (int i=22; i<=36; i++)
-                                {
-                                    check[i] = false;
-                                }
-                                menuFlip(optionsPvAIHover.surface(), check[35]); // the one player game mode button is highlighted
-                            }
-                        }
-                    }
-                    else
-                    {
-                        if (location.y < 510)
-                        {
-                            if (!check[22])
-                            {
-                                for (int i=22; i<=36; i++)
-                                {
-                                    check[i] = false;
-                                }
-                                    menuFlip(options.surface(), check[22]); // no buttons are highlighted between the game mode option and the back button
-                            }
-                        }
-                        else
-                        {
-                            if (location.x < 450)
-                            {
-                                if (!check[36])
-                                {
-                                    for (int i=22; i<=36; i++)
-                                    {
-                                        check[i] = false;
-                                    }
-                                    menuFlip(optionsBackHover.surface(), check[36]); // the back button is highlighted
-                                }
-                            }
-                            else
-                            {
-                                if (!check[22])
-                                {
-                                    for (int i=22; i<=36; i++)
-                                    {
-                                        check[i] = false;
-                                    }
-                                        menuFlip(options.surface(), check[22]); // no buttons are highlighted below the back button
-                                }
-                            }
-                        }
-                    }
-                }
-            }
-        }
-    }
+    show(options, options.highlight(location));
 }
 
 ClickType Menu::click(Coord location) // tells the program which buttons to activate. the previous three functions basically show the buttons and the following three allow them to be clicked on
@@ -622,23 +294,21 @@ ClickType Menu::clickMenu(Coord location)
                 if (location.y < 350) // the options button is clicked
                 {
                     GameOptions = true;
-                    menuFlip(options.surface(), GameOptions);
+                    show(options);
                 }
                 else
                 {
                     if (location.y < 400) // the instructions button is clicked
                     {
                         GameInstructions = true;
-                        menuFlip(instructions.surface(), check[9]);
-                        check[10] = false;
+                        show(instructions);
                     }
                     else
                     {
                         if (location.y < 450) // the credits button is clicked
                         {
                             GameCredits = true;
-                            menuFlip(credits.surface(), check[11]);
-                            check[12] = false;
+                            show(credits);
                         }
                         else
                         {
@@ -664,7 +334,7 @@ ClickType Menu::clickMenu(Coord location)
             if (location.y > 550)
             {
                 GameInstructions = GameCredits = false;
-                menuFlip(sproutsMenu.surface(), check[1]);
+                show(sproutsMenu);
             }
         }
     }
@@ -792,7 +462,7 @@ void Menu::optionsPageClick(Coord location) // the following function changes ch
                         if ((location.y > 510) && (location.x < 450)) // the back button is pressed
                         {
                             GameOptions = false;
-                            menuFlip(sproutsMenu.surface(), check[1]);
+                            show(sproutsMenu);
                         }
                     }
                 }
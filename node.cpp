@@ -33,7 +33,7 @@ bool Node::vertical() const
 // The initial call. There are two of these since we have to pass in the
 // original node's address so that we can later find if we have returned to
 // this.
-void Node::walk(vector<Area*>& areas)
+void Node::walk(vector<Area*>& areas, AreaTable& found)
 {
     // Walk each connection
     for (int i = 0; i < 3; i++)
@@ -42,39 +42,36 @@ void Node::walk(vector<Area*>& areas)
         // is the initial function call, recurse. Note we pass in this nodes
         // address so we'll know when we return to it.
         if (connections[i].exists())
-            connections[i].dest->walk(areas, Area(), &connections[i], this);
+            connections[i].dest->walk(areas, found, Area(), &connections[i], this);
+    }
+}
+
+// Add the area to the vector if we don't have it yet. The canonical form makes
+// this a hash lookup and usually one comparison.
+static void keepArea(vector<Area*>& areas, AreaTable& found, const Area& history)
+{
+    Area area(history);
+    area.canonicalize();
+
+    if (!found.find(area))
+    {
+        Area* keep = new Area(area);
+        keep->buildIndex();
+        areas.push_back(keep);
+        found.insert(keep);
     }
 }
 
 // Note: we could pass in history by reference if we delete added entries at
 // the end of each iteration
-void Node::walk(vector<Area*>& areas, Area history, Connection* connection, Node* initial)
+void Node::walk(vector<Area*>& areas, AreaTable& found, Area history, Connection* connection, Node* initial)
 {
     history.push_back(connection);
 
     // We have a circuit/loop if we're back to the start node
     if (connection->dest == initial)
     {
-        //rotate the area to allow for uniqueness comparison
-        Area::iterator iter;
-        int oSize=history.size();
-        Area rotatedHist(oSize);
-        iter = min_element(history.begin(),history.end(),LineCmp);
-
-        if (iter==history.end()) //this should never happen
-            throw "Node::walk() didn't find minimum";
-
-        for (int i=0;i<oSize;i++)
-            rotatedHist[i]=history[(iter-history.begin()+i)%oSize];
-
-        // Add a copy of the rotated history to areas vector if it isn't
-        // already there
-        if (find_if(areas.begin(), areas.end(), AreaFind(rotatedHist)) == areas.end())
-        {
-            Area* keep = new Area(rotatedHist);
-            areas.push_back(keep);
-        }
-
+        keepArea(areas, found, history);
         return;
     }
 
@@ -87,10 +84,48 @@ void Node::walk(vector<Area*>& areas, Area history, Connection* connection, Node
         if (connections[i].exists() &&
             find_if(history.begin(), history.end(),
             LineFind(connections[i].line)) == history.end())
-            connections[i].dest->walk(areas, history, &connections[i], initial);
+            connections[i].dest->walk(areas, found, history, &connections[i], initial);
     }
 }
 
+// Rather than finding every circuit, this finds the faces of the drawing. If
+// we always take the next line clockwise from the one we came in on, we'll go
+// around the edge of a face and end up where we started. Every connection is
+// on exactly one face, so after starting from each one we've found all of
+// them in linear time.
+//
+// Faces that have other lines inside them have one area for the outside and
+// one going around the outside of the inner lines. That's fine for isInArea()
+// since it only cares about which lines a point is inside of.
+void Node::trace(vector<Area*>& areas, AreaTable& found, set<Connection*>& traced)
+{
+    for (int i = 0; i < 3; i++)
+    {
+        Connection* connection = &connections[i];
+        Area face;
+
+        if (!connection->exists() || traced.find(connection) != traced.end())
+            continue;
+
+        // Go around until we're back to this connection
+        while (traced.insert(connection).second)
+        {
+            face.push_back(connection);
+            connection = connection->dest->next(connection->line);
+        }
+
+        // Lines sticking out into a face are gone over once in each direction.
+        // If that's all there is, it doesn't go around anything.
+        bool around = false;
+
+        for (int j = 0; j < face.size() && !around; j++)
+            if (count_if(face.begin(), face.end(), LineFind(face[j]->line)) == 1)
+                around = true;
+
+        if (around)
+            keepArea(areas, found, face);
+    }
+}
 void Node::setAreasets(Areaset* sets[2])
 {
     areasets[0]=sets[0];
@@ -114,88 +149,145 @@ bool Node::addConnection(const Connection& con)
 
 void Node::updateOpen()
 {
+    const Line* in[3];
     int count = 0;
 
-    // Blank it again
-    fill(&open[0], &open[0]+4, true); // By default every direction is open
-
-    // For each of the connections, set open[dir] to false
     for (int i = 0; i < 3; i++)
+        if (connections[i].exists())
+            in[count++] = connections[i].line;
+
+    switch (openings(in, count, open))
     {
+        case EntryBadLine:
+            // Let direction() say which one
+            for (int i = 0; i < count; i++)
+                direction(*in[i]);
+            break;
+        case EntryCollision:
+            throw NodeEntryCollision();
+        case EntryCorner:
+            throw InvalidCorner();
+        default:
+            break;
+    }
+}
+
+Node::Entry Node::checkEntry(const Line* first, const Line* second) const
+{
+    const Line* in[5];
+    bool after[4];
+    int count = 0;
+
+    for (int i = 0; i < 3; i++)
         if (connections[i].exists())
-        {
-            const Coord* other;
+            in[count++] = connections[i].line;
 
-            // Keep track so we can check if it's valid afterwards
-            ++count;
+    in[count++] = first;
 
-            // Note that this can be simplified if we always make sure a line
-            // ends with the node pointed to by dest, but until then, check
-            // based on coordinates
-            const Line& line = *(connections[i].line);
-
-            // A line must be at least the beginning and ending node
-            if (line.size() < 2)
-                throw InvalidLine(line);
-
-            if (line.front() == loci) // At beginning
-                other = &line[1];
-            else if (line.back() == loci) // At end
-                other = &line[line.size()-2];
-            else // In the middle? It should be at the beginning or end!
-                throw InvalidLine(line);
-
-            // It can't be the same point
-            if (loci == *other)
-                throw InvalidLine(line);
-
-            // Determine direction
-            if (loci.x == other->x) // Vertical
-            {
-                if (loci.y < other->y) // Down
-                {
-                    if (open[Down])
-                        open[Down] = false;
-                    else
-                        throw NodeEntryCollision();
-                }
-                else // Up
-                {
-                    if (open[Up])
-                        open[Up] = false;
-                    else
-                        throw NodeEntryCollision();
-                }
-            }
-            else if (loci.y == other->y) // Horizontal
-            {
-                if (loci.x < other->x) // Right
-                {
-                    if (open[Right])
-                        open[Right] = false;
-                    else
-                        throw NodeEntryCollision();
-                }
-                else // Left
-                {
-                    if (open[Left])
-                        open[Left] = false;
-                    else
-                        throw NodeEntryCollision();
-                }
-            }
-            else // Neither, so invalid
-            {
-                throw InvalidLine(line);
-            }
-        }
+    if (second)
+        in[count++] = second;
+
+    if (count > 3)
+        return EntryFull;
+
+    return openings(in, count, after);
+}
+
+// Set sides[dir] to false for each of the lines, checking it's valid
+Node::Entry Node::openings(const Line* const in[], int count, bool sides[4]) const
+{
+    fill(&sides[0], &sides[0]+4, true); // By default every direction is open
+
+    for (int i = 0; i < count; i++)
+    {
+        Dir dir;
+
+        if (!side(*in[i], dir))
+            return EntryBadLine;
+
+        if (sides[dir])
+            sides[dir] = false;
+        else
+            return EntryCollision;
     }
 
     // If there's only two, they must be 180 degrees from each other
     if (count == 2 &&
-        !((open[Left] == false && open[Right] == false) ||
-         (open[Up]   == false && open[Down]  == false)))
-        throw InvalidCorner();
+        !((sides[Left] == false && sides[Right] == false) ||
+         (sides[Up]   == false && sides[Down]  == false)))
+        return EntryCorner;
+
+    return EntryOK;
+}
+
+// Determine which side of this node the line comes in on
+Node::Dir Node::direction(const Line& line) const
+{
+    Dir dir;
+
+    if (!side(line, dir))
+        throw InvalidLine(line);
+
+    return dir;
+}
+
+bool Node::side(const Line& line, Dir& dir) const
+{
+    const Coord* other;
+
+    // A line must be at least the beginning and ending node
+    if (line.size() < 2)
+        return false;
+
+    // Note that this can be simplified if we always make sure a line ends
+    // with the node pointed to by dest, but until then, check based on
+    // coordinates
+    if (line.front() == loci) // At beginning
+        other = &line[1];
+    else if (line.back() == loci) // At end
+        other = &line[line.size()-2];
+    else // In the middle? It should be at the beginning or end!
+        return false;
+
+    // It can't be the same point
+    if (loci == *other)
+        return false;
+
+    if (loci.x == other->x) // Vertical
+        dir = (loci.y < other->y)?Down:Up;
+    else if (loci.y == other->y) // Horizontal
+        dir = (loci.x < other->x)?Right:Left;
+    else // Neither, so invalid
+        return false;
+
+    return true;
+}
+
+// We came into this node on the specified line. Look clockwise from that side
+// of the node for the next connection. If there's nothing else, we go back out
+// the way we came.
+Connection* Node::next(const Line* line)
+{
+    Connection* found[4] = { NULL, NULL, NULL, NULL };
+    int in = Up;
+
+    for (int i = 0; i < 3; i++)
+    {
+        if (connections[i].exists())
+        {
+            Dir dir = direction(*connections[i].line);
+            found[dir] = &connections[i];
+
+            if (connections[i].line == line)
+                in = dir;
+        }
+    }
+
+    for (int i = 1; i < 4; i++)
+        if (found[(in+i)%4])
+            return found[(in+i)%4];
+
+    return found[in];
 }
 
 int Node::conCount() const
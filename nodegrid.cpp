@@ -0,0 +1,128 @@
+/*
+*   Finding nodes by where they are
+*/
+#include <algorithm>
+#include "headers/nodegrid.h"
+
+// Size of the grid squares in pixels, about the size of a node on the screen
+static const int square = 16;
+
+// There are at least this many buckets, and at least twice as many as nodes
+static const int minBuckets = 64;
+
+// Which square a coordinate is in, rounding down for negatives too
+static int squareOf(int v)
+{
+    return (v >= 0)?v/square:-((square - 1 - v)/square);
+}
+
+int NodeGrid::bucket(int x, int y) const
+{
+    return ((unsigned int)x*73856093u ^ (unsigned int)y*19349663u) & (heads.size() - 1);
+}
+
+void NodeGrid::rehash(int buckets)
+{
+    heads.assign(buckets, -1);
+
+    // In order so the last one is first in its list
+    for (int i = 0; i < points.size(); i++)
+    {
+        const int b = bucket(squareOf(points[i].x), squareOf(points[i].y));
+        next[i] = heads[b];
+        heads[b] = i;
+    }
+}
+
+void NodeGrid::clear()
+{
+    heads.clear();
+    next.clear();
+    points.clear();
+}
+
+void NodeGrid::add(Coord point)
+{
+    points.push_back(point);
+    next.push_back(-1);
+
+    if (2*points.size() > heads.size())
+    {
+        rehash(max<int>(minBuckets, 2*heads.size()));
+    }
+    else
+    {
+        const int b = bucket(squareOf(point.x), squareOf(point.y));
+        next.back() = heads[b];
+        heads[b] = points.size() - 1;
+    }
+}
+
+void NodeGrid::removeLast()
+{
+    const Coord& point = points.back();
+
+    heads[bucket(squareOf(point.x), squareOf(point.y))] = next.back();
+    points.pop_back();
+    next.pop_back();
+}
+
+int NodeGrid::find(Coord point, int* count) const
+{
+    int found = -1;
+    int same = 0;
+
+    if (!heads.empty())
+    {
+        for (int i = heads[bucket(squareOf(point.x), squareOf(point.y))]; i != -1; i = next[i])
+        {
+            if (points[i] == point)
+            {
+                found = i; // Going from the newest, so this is the lowest yet
+                ++same;
+            }
+        }
+    }
+
+    if (count)
+        *count = same;
+
+    return found;
+}
+
+void NodeGrid::findIn(Coord from, Coord to, vector<int>& found) const
+{
+    const int left = min(from.x, to.x);
+    const int right = max(from.x, to.x);
+    const int top = min(from.y, to.y);
+    const int bottom = max(from.y, to.y);
+    const int columns = squareOf(right) - squareOf(left) + 1;
+    const int rows = squareOf(bottom) - squareOf(top) + 1;
+
+    // Looking at every node is faster than going through a lot of squares
+    if (heads.empty() || (double)columns*rows > heads.size()/4)
+    {
+        for (int i = 0; i < points.size(); i++)
+            if (points[i].x >= left && points[i].x <= right &&
+                points[i].y >= top && points[i].y <= bottom)
+                found.push_back(i);
+
+        return;
+    }
+
+    for (int x = squareOf(left); x <= squareOf(right); x++)
+    {
+        for (int y = squareOf(top); y <= squareOf(bottom); y++)
+        {
+            for (int i = heads[bucket(x, y)]; i != -1; i = next[i])
+            {
+                // Only the ones in this square, in case another one in the
+                // rectangle shares the bucket
+                if (squareOf(points[i].x) == x && squareOf(points[i].y) == y &&
+                    points[i].x >= left && points[i].x <= right &&
+                    points[i].y >= top && points[i].y <= bottom)
+                    found.push_back(i);
+            }
+        }
+    }
+}
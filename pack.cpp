@@ -0,0 +1,124 @@
+/*
+*   Loading images from the pack of already decoded ones
+*/
+#include <cstring>
+#include <sys/stat.h>
+#include "headers/pack.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#endif
+
+using namespace PackFormat;
+
+Pack::Pack(const string& file)
+    :data(NULL), length(0), mapping(NULL)
+{
+#ifdef _WIN32
+    HANDLE f = CreateFileA(file.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL,
+                           OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+
+    if (f == INVALID_HANDLE_VALUE)
+        return;
+
+    length = GetFileSize(f, NULL);
+    mapping = CreateFileMappingA(f, NULL, PAGE_READONLY, 0, 0, NULL);
+    CloseHandle(f);
+
+    if (mapping)
+        data = static_cast<const char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+
+    if (!data)
+        close();
+#else
+    const int f = open(file.c_str(), O_RDONLY);
+    struct stat info;
+
+    if (f < 0)
+        return;
+
+    if (fstat(f, &info) == 0 && info.st_size > 0)
+    {
+        void* mapped = mmap(NULL, info.st_size, PROT_READ, MAP_SHARED, f, 0);
+
+        if (mapped != MAP_FAILED)
+        {
+            data = static_cast<const char*>(mapped);
+            length = info.st_size;
+        }
+    }
+
+    ::close(f);
+#endif
+
+    // Don't use it if it's not one or it's cut off
+    const Header* header = reinterpret_cast<const Header*>(data);
+
+    if (data && (length < sizeof(Header) || memcmp(header->magic, magic, sizeof(magic)) != 0 ||
+        (length - sizeof(Header))/sizeof(Entry) < header->count))
+        close();
+}
+
+Pack& Pack::assets()
+{
+    static Pack pack("images/assets.pack");
+    return pack;
+}
+
+SDL_Surface* Pack::surface(const string& name) const
+{
+    if (!data)
+        return NULL;
+
+    const Header* header = reinterpret_cast<const Header*>(data);
+    const Entry* entries = reinterpret_cast<const Entry*>(data + sizeof(Header));
+
+    for (Uint32 i = 0; i < header->count; i++)
+    {
+        const Entry& e = entries[i];
+
+        if (strncmp(e.name, name.c_str(), sizeof(e.name)) != 0)
+            continue;
+
+        // If the image was changed, what's in the pack is out of date
+        struct stat info;
+
+        if (stat(name.c_str(), &info) == 0 && (Uint32)info.st_size != e.size)
+            return NULL;
+
+        if (e.w == 0 || e.h == 0 || e.offset > length || (length - e.offset)/4/e.w < e.h)
+            return NULL;
+
+        return SDL_CreateRGBSurfaceFrom(const_cast<char*>(data + e.offset), e.w, e.h,
+                                        32, e.w*4, rmask, gmask, bmask, 0);
+    }
+
+    return NULL;
+}
+
+void Pack::close()
+{
+#ifdef _WIN32
+    if (data)
+        UnmapViewOfFile(data);
+
+    if (mapping)
+        CloseHandle(mapping);
+#else
+    if (data)
+        munmap(const_cast<char*>(data), length);
+#endif
+
+    data = NULL;
+    length = 0;
+    mapping = NULL;
+}
+
+Pack::~Pack()
+{
+    close();
+}
@@ -0,0 +1,121 @@
+/*
+*   Decode the images ahead of time into one file that the game can load
+*   without decoding them
+*
+*   Usage: pack output.pack image...
+*
+*   Run it from where the game is run, giving the images by the paths the game
+*   loads them by, e.g. images/Options.jpg, and the output as
+*   images/assets.pack, which is where the game looks for it.
+*
+*   The game only uses what's in the pack for images that are the same size
+*   as when they were packed, so run it again after changing them.
+*/
+#include <vector>
+#include <string>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <sys/stat.h>
+#include <SDL.h>
+#include <SDL_image.h>
+#include "../headers/pack.h"
+
+using namespace std;
+using namespace PackFormat;
+
+// Where the pixels of each image start is a multiple of this
+static const Uint32 align = 16;
+
+int main(int argc, char* argv[])
+{
+    if (argc < 3)
+    {
+        cerr << "Usage: pack output.pack image..." << endl;
+        return 1;
+    }
+
+    vector<Entry> entries;
+    vector<SDL_Surface*> images;
+    Uint32 offset = sizeof(Header) + (argc - 2)*sizeof(Entry);
+
+    for (int i = 2; i < argc; i++)
+    {
+        Entry e;
+        struct stat info;
+        SDL_Surface* loaded = IMG_Load(argv[i]);
+
+        if (!loaded || stat(argv[i], &info) != 0 || strlen(argv[i]) >= sizeof(e.name))
+        {
+            cerr << "Error: could not load image: " << argv[i] << endl;
+            return 1;
+        }
+
+        // Copy it into the pack's format, without blending
+        SDL_Surface* image = SDL_CreateRGBSurface(SDL_SWSURFACE, loaded->w, loaded->h,
+                                                  32, rmask, gmask, bmask, 0);
+
+        if (!image)
+        {
+            cerr << "Error: out of memory" << endl;
+            return 1;
+        }
+
+        SDL_SetAlpha(loaded, 0, SDL_ALPHA_OPAQUE);
+        SDL_BlitSurface(loaded, NULL, image, NULL);
+        SDL_FreeSurface(loaded);
+
+        memset(&e, 0, sizeof(e));
+        strcpy(e.name, argv[i]);
+        e.size = info.st_size;
+        e.w = image->w;
+        e.h = image->h;
+        e.offset = (offset + align - 1)/align*align;
+        offset = e.offset + e.w*e.h*4;
+
+        entries.push_back(e);
+        images.push_back(image);
+    }
+
+    FILE* out = fopen(argv[1], "wb");
+
+    if (!out)
+    {
+        cerr << "Error: could not write " << argv[1] << endl;
+        return 1;
+    }
+
+    Header header;
+    memcpy(header.magic, magic, sizeof(magic));
+    header.count = entries.size();
+
+    fwrite(&header, sizeof(header), 1, out);
+    fwrite(&entries[0], sizeof(Entry), entries.size(), out);
+
+    long at = sizeof(Header) + entries.size()*sizeof(Entry);
+    const char zeros[align] = { 0 };
+
+    for (int i = 0; i < images.size(); i++)
+    {
+        fwrite(zeros, 1, entries[i].offset - at, out);
+
+        // Rows of the surface might be padded, but not in the pack
+        for (int y = 0; y < images[i]->h; y++)
+            fwrite(static_cast<char*>(images[i]->pixels) + y*images[i]->pitch,
+                   images[i]->w*4, 1, out);
+
+        at = entries[i].offset + entries[i].w*entries[i].h*4;
+        SDL_FreeSurface(images[i]);
+    }
+
+    if (fclose(out) != 0)
+    {
+        cerr << "Error: could not write " << argv[1] << endl;
+        return 1;
+    }
+
+    cout << "Packed " << entries.size() << " images into " << argv[1]
+         << " (" << at/1024 << " KiB)" << endl;
+
+    return 0;
+}
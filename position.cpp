@@ -0,0 +1,839 @@
+/*
+ * Implementation of the abstract position used by the AI
+ */
+#include <map>
+#include <algorithm>
+#include "headers/position.h"
+
+// One walk around a face of the drawing, going counterclockwise around the
+// inside of a face or clockwise around a group of lines inside of one
+struct Walk
+{
+    Boundary vertices;
+    Line points; // Where it went, for telling which face it's in
+    long long area; // Twice the signed area, negative around the inside of a face
+    int component; // Which connected group of lines it goes around
+};
+
+// Which side of the node at loci the line comes out of: 0 up, 1 right, 2 down,
+// or 3 left like Node::Dir
+static int side(Coord loci, const Line& line)
+{
+    const Coord& other = (line.front() == loci)?line[1]:line[line.size()-2];
+
+    if (loci.x == other.x)
+        return (loci.y < other.y)?2:0;
+
+    return (loci.x < other.x)?1:3;
+}
+
+// Twice the signed area of a closed polygon. Since y increases downwards, this
+// is positive when going clockwise on the screen.
+static long long area(const Line& polygon)
+{
+    long long sum = 0;
+
+    for (int i = 0; i < polygon.size(); i++)
+    {
+        const Coord& a = polygon[i];
+        const Coord& b = polygon[(i+1)%polygon.size()];
+
+        sum += (long long)a.x*b.y - (long long)b.x*a.y;
+    }
+
+    return sum;
+}
+
+// Whether a point is inside a rectilinear polygon that doesn't go through it.
+// Count the horizontal edges above it, including the left end of each edge
+// but not the right so corners aren't counted twice.
+static bool inside(const Line& polygon, Coord point)
+{
+    bool in = false;
+
+    for (int i = 0; i < polygon.size(); i++)
+    {
+        const Coord& a = polygon[i];
+        const Coord& b = polygon[(i+1)%polygon.size()];
+
+        if (a.y == b.y && a.y < point.y &&
+            min(a.x, b.x) <= point.x && point.x < max(a.x, b.x))
+            in = !in;
+    }
+
+    return in;
+}
+
+// The vertices going forwards along a boundary from one place to another
+static Boundary part(const Boundary& boundary, int from, int to)
+{
+    Boundary result;
+
+    for (int i = from; ; i = (i+1)%boundary.size())
+    {
+        result.push_back(boundary[i]);
+
+        if (i == to)
+            break;
+    }
+
+    return result;
+}
+
+// All the way around a boundary and back to where we started, which is only
+// there once if it's a vertex by itself
+static Boundary around(const Boundary& boundary, int from)
+{
+    Boundary result = part(boundary, from, (from+boundary.size()-1)%boundary.size());
+
+    if (boundary.size() > 1)
+        result.push_back(boundary[from]);
+
+    return result;
+}
+
+Position::Position(int spots)
+    :lives(spots, 3), regions(1)
+{
+    for (int i = 0; i < spots; i++)
+        regions[0].push_back(Boundary(1, i));
+
+    simplify();
+}
+
+// Walk around every face of the drawing to find the boundaries and then figure
+// out which face each one is around
+Position::Position(const GameState& s)
+    :lives(s.nodeCount(), 3)
+{
+    const int n = s.nodeCount();
+    vector<Line> lines(s.lineCount());
+    vector<int> sides(n*3, -1); // Side of the node each connection is on
+    vector<bool> walked(n*3, false);
+    vector<int> component(n, -1);
+    vector<Walk> walks;
+
+    for (int i = 0; i < lines.size(); i++)
+        lines[i] = s.line(i);
+
+    for (int i = 0; i < n; i++)
+    {
+        for (int j = 0; j < 3; j++)
+        {
+            if (s.connectionLine(i, j) != -1)
+            {
+                sides[i*3+j] = side(s.loci(i), lines[s.connectionLine(i, j)]);
+                --lives[i];
+            }
+        }
+    }
+
+    // Number the connected groups of lines
+    for (int i = 0; i < n; i++)
+    {
+        if (component[i] != -1)
+            continue;
+
+        vector<int> todo(1, i);
+        component[i] = i;
+
+        while (!todo.empty())
+        {
+            int node = todo.back();
+            todo.pop_back();
+
+            for (int j = 0; j < 3; j++)
+            {
+                int dest = s.connectionDest(node, j);
+
+                if (dest != -1 && component[dest] == -1)
+                {
+                    component[dest] = i;
+                    todo.push_back(dest);
+                }
+            }
+        }
+    }
+
+    for (int i = 0; i < n; i++)
+    {
+        // A vertex by itself is its own boundary
+        if (lives[i] == 3)
+        {
+            Walk walk;
+            walk.vertices.push_back(i);
+            walk.points.push_back(s.loci(i));
+            walk.area = 0;
+            walk.component = component[i];
+            walks.push_back(walk);
+        }
+
+        // Otherwise, start walking out of every connection we haven't already
+        // gone out of. Coming into a node, take the next line clockwise from
+        // the one we came in on like Node::trace(), which keeps the face on
+        // the left.
+        for (int j = 0; j < 3; j++)
+        {
+            if (sides[i*3+j] == -1 || walked[i*3+j])
+                continue;
+
+            Walk walk;
+            int node = i;
+            int con = j;
+
+            do
+            {
+                walked[node*3+con] = true;
+                walk.vertices.push_back(node);
+
+                const int number = s.connectionLine(node, con);
+                Line line = lines[number];
+
+                if (!(line.front() == s.loci(node)))
+                    reverse(line.begin(), line.end());
+
+                walk.points.insert(walk.points.end(), line.begin(), line.end()-1);
+
+                node = s.connectionDest(node, con);
+
+                int found[4] = { -1, -1, -1, -1 };
+                int in = 0;
+
+                for (int k = 0; k < 3; k++)
+                {
+                    if (sides[node*3+k] != -1)
+                    {
+                        found[sides[node*3+k]] = k;
+
+                        if (s.connectionLine(node, k) == number)
+                            in = sides[node*3+k];
+                    }
+                }
+
+                con = found[in];
+
+                for (int k = 1; k < 4; k++)
+                {
+                    if (found[(in+k)%4] != -1)
+                    {
+                        con = found[(in+k)%4];
+                        break;
+                    }
+                }
+            } while (node != i || con != j);
+
+            walk.area = area(walk.points);
+            walk.component = component[i];
+            walks.push_back(walk);
+        }
+    }
+
+    // Each walk around the inside of a face is the outer edge of that face.
+    // The rest go around groups of lines in the smallest face made by other
+    // lines that is around them, or the outside face if there isn't one.
+    vector<int> face(walks.size(), -1);
+    int faces = 0;
+
+    for (int i = 0; i < walks.size(); i++)
+        if (walks[i].area < 0)
+            face[i] = faces++;
+
+    regions.resize(faces+1);
+
+    for (int i = 0; i < walks.size(); i++)
+    {
+        if (face[i] != -1)
+            continue;
+
+        int best = -1;
+
+        for (int j = 0; j < walks.size(); j++)
+        {
+            if (walks[j].area < 0 && walks[j].component != walks[i].component &&
+                (best == -1 || walks[j].area > walks[best].area) &&
+                inside(walks[j].points, walks[i].points.front()))
+                best = j;
+        }
+
+        face[i] = (best == -1)?faces:face[best];
+    }
+
+    for (int i = 0; i < walks.size(); i++)
+        regions[face[i]].push_back(walks[i].vertices);
+
+    simplify();
+}
+
+// Every pair of places on the boundaries of a region can be connected if the
+// vertices have enough lives. If they're on different boundaries, the line
+// joins them into one. If they're on the same boundary, the region is split
+// and the other boundaries can go on either side.
+vector<AbstractMove> Position::moves() const
+{
+    vector<AbstractMove> found;
+
+    for (int r = 0; r < regions.size(); r++)
+    {
+        const Region& region = regions[r];
+
+        for (int b1 = 0; b1 < region.size(); b1++)
+        {
+            for (int i1 = 0; i1 < region[b1].size(); i1++)
+            {
+                for (int b2 = b1; b2 < region.size(); b2++)
+                {
+                    for (int i2 = (b1 == b2)?i1:0; i2 < region[b2].size(); i2++)
+                    {
+                        // A vertex to itself uses two lives
+                        if (region[b1][i1] == region[b2][i2] &&
+                            lives[region[b1][i1]] < 2)
+                            continue;
+
+                        AbstractMove move;
+                        move.region = r;
+                        move.boundary1 = b1;
+                        move.index1 = i1;
+                        move.boundary2 = b2;
+                        move.index2 = i2;
+
+                        if (b1 != b2)
+                        {
+                            found.push_back(move);
+                            continue;
+                        }
+
+                        const int others = region.size()-1;
+
+                        for (int groups = 0; groups < (1 << others); groups++)
+                        {
+                            move.group.resize(others);
+
+                            for (int k = 0; k < others; k++)
+                                move.group[k] = groups & (1 << k);
+
+                            found.push_back(move);
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    return found;
+}
+
+Position Position::play(const AbstractMove& move) const
+{
+    Position next(*this);
+    const Region& region = regions[move.region];
+    const Boundary& first = region[move.boundary1];
+    const Boundary& second = region[move.boundary2];
+    const int middle = lives.size();
+
+    --next.lives[first[move.index1]];
+    --next.lives[second[move.index2]];
+    next.lives.push_back(1);
+    next.regions.erase(next.regions.begin() + move.region);
+
+    if (move.boundary1 != move.boundary2)
+    {
+        // Go around the first boundary, over to the second, around that, and
+        // back again
+        Region joined;
+        Boundary boundary = around(first, move.index1);
+        Boundary rest = around(second, move.index2);
+
+        boundary.push_back(middle);
+        boundary.insert(boundary.end(), rest.begin(), rest.end());
+        boundary.push_back(middle);
+
+        for (int b = 0; b < region.size(); b++)
+            if (b != move.boundary1 && b != move.boundary2)
+                joined.push_back(region[b]);
+
+        joined.push_back(boundary);
+        next.regions.push_back(joined);
+    }
+    else
+    {
+        // One side has the boundary from the start to the end, the other from
+        // the end back to the start, or all the way around for a loop
+        Region one(1, part(first, move.index1, move.index2));
+        Region two(1, (move.index1 == move.index2)?around(first, move.index1):
+                                                   part(first, move.index2, move.index1));
+        int k = 0;
+
+        one[0].push_back(middle);
+        two[0].push_back(middle);
+
+        for (int b = 0; b < region.size(); b++)
+        {
+            if (b == move.boundary1)
+                continue;
+
+            if (move.group[k++])
+                one.push_back(region[b]);
+            else
+                two.push_back(region[b]);
+        }
+
+        next.regions.push_back(one);
+        next.regions.push_back(two);
+    }
+
+    next.simplify();
+
+    return next;
+}
+
+// Find which part a region is in, pointing everything on the way at it
+static int root(vector<int>& parent, int r)
+{
+    if (parent[r] != r)
+        parent[r] = root(parent, parent[r]);
+
+    return parent[r];
+}
+
+vector<Position> Position::components() const
+{
+    vector<int> parent(regions.size());
+    vector<int> owner(lives.size(), -1); // A region each vertex is in
+
+    for (int r = 0; r < regions.size(); r++)
+        parent[r] = r;
+
+    for (int r = 0; r < regions.size(); r++)
+    {
+        for (int b = 0; b < regions[r].size(); b++)
+        {
+            for (int i = 0; i < regions[r][b].size(); i++)
+            {
+                const int vertex = regions[r][b][i];
+
+                if (owner[vertex] == -1)
+                    owner[vertex] = r;
+                else
+                    parent[root(parent, r)] = root(parent, owner[vertex]);
+            }
+        }
+    }
+
+    vector<Position> parts;
+    vector<int> part(regions.size(), -1);
+
+    for (int r = 0; r < regions.size(); r++)
+    {
+        const int top = root(parent, r);
+
+        if (part[top] == -1)
+        {
+            part[top] = parts.size();
+            parts.push_back(Position());
+            parts.back().lives = lives;
+        }
+
+        parts[part[top]].regions.push_back(regions[r]);
+    }
+
+    return parts;
+}
+
+bool Position::operator==(const Position& p) const
+{
+    return lives == p.lives && sorted().regions == p.sorted().regions;
+}
+
+string Position::str() const
+{
+    map<int, int> count;
+    map<int, char> letters;
+    string s;
+
+    for (int r = 0; r < regions.size(); r++)
+        for (int b = 0; b < regions[r].size(); b++)
+            for (int i = 0; i < regions[r][b].size(); i++)
+                ++count[regions[r][b][i]];
+
+    for (int r = 0; r < regions.size(); r++)
+    {
+        for (int b = 0; b < regions[r].size(); b++)
+        {
+            if (b > 0)
+                s += '.';
+
+            for (int i = 0; i < regions[r][b].size(); i++)
+            {
+                const int vertex = regions[r][b][i];
+
+                if (count[vertex] > 1)
+                {
+                    if (letters.find(vertex) == letters.end())
+                    {
+                        char letter = 'A' + letters.size();
+                        letters[vertex] = letter;
+                    }
+
+                    s += letters[vertex];
+                }
+                else
+                {
+                    s += '0' + 3 - lives[vertex];
+                }
+            }
+        }
+
+        s += '}';
+    }
+
+    return s + '!';
+}
+
+string Position::key() const
+{
+    vector<int> count(lives.size(), 0);
+    string best;
+
+    for (int r = 0; r < regions.size(); r++)
+        for (int b = 0; b < regions[r].size(); b++)
+            for (int i = 0; i < regions[r][b].size(); i++)
+                ++count[regions[r][b][i]];
+
+    arranged(count, false, best);
+    arranged(count, true, best);
+
+    return best + '!';
+}
+
+// One boundary for arranged(), what it looks like with all the letters the
+// same starting from where that comes first, and every place it can start to
+// look like that
+struct Shape
+{
+    string text;
+    int boundary;
+    vector<int> starts;
+    bool lettered; // Whether there are any letters in it
+
+    bool operator<(const Shape& s) const
+    {
+        return text < s.text || (text == s.text && boundary < s.boundary);
+    }
+};
+
+// How many times to try another way of breaking a tie for one key before
+// taking the first way for the rest, so very symmetric positions don't take
+// long. Those may then get a different key than the same position numbered
+// differently, which only means searching it twice.
+static const int tieTries = 64;
+
+// Writes a position out for arranged() in the order of the shapes, trying
+// each of the regions and boundaries that look the same there and each of the
+// places a boundary can start, since those give different letters
+struct Writer
+{
+    const vector<Region>& regions;
+    const vector<int>& lives;
+    const vector<int>& count;
+    const bool mirror;
+
+    vector<vector<Shape> > shapes;     // Sorted, for each region
+    vector<pair<string, int> > order;  // Regions by how they look
+    vector<bool> regionUsed;           // By place in the order
+    vector<vector<bool> > shapeUsed;   // By place in the shapes
+    vector<char> letters;
+    char next;
+    int tries;
+    string s;
+    string& best;
+
+    Writer(const vector<Region>& regions, const vector<int>& lives,
+           const vector<int>& count, bool mirror, string& best)
+        :regions(regions), lives(lives), count(count), mirror(mirror),
+         shapes(regions.size()), regionUsed(regions.size(), false),
+         shapeUsed(regions.size()), letters(lives.size(), 0), next('A'),
+         tries(tieTries), best(best)
+    {
+    }
+
+    void region(int o);
+    void boundary(int o, int r, int b);
+    bool write(int r, const Shape& shape, int start);
+    void erase(int r, const Shape& shape, size_t length, char first);
+};
+
+// Every region that looks like the one that comes next in the order could go
+// there, but which one only matters if they have letters
+void Writer::region(int o)
+{
+    if (o == order.size())
+    {
+        if (best.empty() || s < best)
+            best = s;
+
+        return;
+    }
+
+    for (int t = o; t < order.size() && order[t].first == order[o].first; t++)
+    {
+        if (regionUsed[t])
+            continue;
+
+        const int r = order[t].second;
+
+        regionUsed[t] = true;
+        boundary(o, r, 0);
+        regionUsed[t] = false;
+
+        if (order[t].first.find('*') == string::npos || --tries <= 0)
+            break;
+    }
+}
+
+void Writer::boundary(int o, int r, int b)
+{
+    const vector<Shape>& shape = shapes[r];
+
+    if (b == shape.size())
+    {
+        s += '}';
+        region(o+1);
+        s.erase(s.size()-1);
+
+        return;
+    }
+
+    if (b > 0)
+        s += '.';
+
+    for (int t = b; t < shape.size() && shape[t].text == shape[b].text; t++)
+    {
+        if (shapeUsed[r][t])
+            continue;
+
+        for (int k = 0; k < shape[t].starts.size(); k++)
+        {
+            const size_t length = s.size();
+            const char first = next;
+
+            if (write(r, shape[t], shape[t].starts[k]))
+            {
+                shapeUsed[r][t] = true;
+                boundary(o, r, b+1);
+                shapeUsed[r][t] = false;
+            }
+
+            erase(r, shape[t], length, first);
+
+            if (!shape[t].lettered || --tries <= 0)
+                break;
+        }
+
+        if (!shape[t].lettered || tries <= 0)
+            break;
+    }
+
+    if (b > 0)
+        s.erase(s.size()-1);
+}
+
+// Add a boundary going around from a start, and whether that could still be
+// smaller than the best so far
+bool Writer::write(int r, const Shape& shape, int start)
+{
+    const Boundary& boundary = regions[r][shape.boundary];
+    const int n = boundary.size();
+
+    for (int j = 0; j < n; j++)
+    {
+        const int i = (start + j)%n;
+        const int vertex = boundary[mirror?n-1-i:i];
+
+        if (count[vertex] > 1)
+        {
+            if (letters[vertex] == 0)
+                letters[vertex] = next++;
+
+            s += letters[vertex];
+        }
+        else
+        {
+            s += '0' + 3 - lives[vertex];
+        }
+    }
+
+    return best.empty() || best.compare(0, s.size(), s) >= 0;
+}
+
+// Take a boundary back off, along with the letters from first on that it gave
+// out
+void Writer::erase(int r, const Shape& shape, size_t length, char first)
+{
+    const Boundary& boundary = regions[r][shape.boundary];
+
+    for (int i = 0; i < boundary.size(); i++)
+        if (letters[boundary[i]] >= first)
+            letters[boundary[i]] = 0;
+
+    next = first;
+    s.erase(length);
+}
+
+// str() with everything ordered by what it would look like with all the
+// letters the same, and the smallest of the ways to write that where the
+// order of those leaves a choice, if it's smaller than the best so far. This
+// is the same for positions that play the same since it doesn't depend on any
+// order they came in.
+void Position::arranged(const vector<int>& count, bool mirror, string& best) const
+{
+    Writer w(regions, lives, count, mirror, best);
+
+    for (int r = 0; r < regions.size(); r++)
+    {
+        for (int b = 0; b < regions[r].size(); b++)
+        {
+            const Boundary& boundary = regions[r][b];
+            const int n = boundary.size();
+            Shape shape;
+
+            shape.text.resize(n);
+            shape.boundary = b;
+            shape.lettered = false;
+
+            for (int i = 0; i < n; i++)
+            {
+                const int vertex = boundary[mirror?n-1-i:i];
+
+                shape.text[i] = (count[vertex] > 1)?'*':'0' + 3 - lives[vertex];
+                shape.lettered |= (count[vertex] > 1);
+            }
+
+            // Smallest rotation, and wherever else it starts the same
+            const string& text = shape.text;
+
+            shape.starts.push_back(0);
+
+            for (int i = 1; i < n; i++)
+            {
+                const int start = shape.starts.front();
+                int j = 0;
+
+                while (j < n && text[(i+j)%n] == text[(start+j)%n])
+                    ++j;
+
+                if (j == n)
+                    shape.starts.push_back(i);
+                else if (text[(i+j)%n] < text[(start+j)%n])
+                    shape.starts.assign(1, i);
+            }
+
+            const int start = shape.starts.front();
+
+            shape.text = text.substr(start) + text.substr(0, start);
+            w.shapes[r].push_back(shape);
+        }
+
+        sort(w.shapes[r].begin(), w.shapes[r].end());
+        w.shapeUsed[r].resize(w.shapes[r].size(), false);
+
+        string text;
+
+        for (int b = 0; b < w.shapes[r].size(); b++)
+            text += w.shapes[r][b].text + '.';
+
+        w.order.push_back(make_pair(text, r));
+    }
+
+    sort(w.order.begin(), w.order.end());
+    w.region(0);
+}
+
+void Position::simplify()
+{
+    vector<int> counted(lives.size(), -1); // Region each vertex was last counted in
+    int kept = 0;
+
+    for (int r = 0; r < regions.size(); r++)
+    {
+        Region& region = regions[r];
+        int total = 0;
+        int boundaries = 0;
+
+        for (int b = 0; b < region.size(); b++)
+        {
+            Boundary& boundary = region[b];
+            int alive = 0;
+
+            for (int i = 0; i < boundary.size(); i++)
+            {
+                const int vertex = boundary[i];
+
+                if (lives[vertex] == 0)
+                    continue;
+
+                boundary[alive++] = vertex;
+
+                // Each vertex's lives only count once
+                if (counted[vertex] != r)
+                {
+                    counted[vertex] = r;
+                    total += lives[vertex];
+                }
+            }
+
+            boundary.resize(alive);
+
+            if (alive > 0)
+                region[boundaries++].swap(boundary);
+        }
+
+        region.resize(boundaries);
+
+        // It takes two lives to draw a line
+        if (total >= 2)
+            regions[kept++].swap(region);
+    }
+
+    regions.resize(kept);
+}
+
+// Start each boundary at its smallest rotation and then sort the boundaries
+// and regions
+Position Position::sorted() const
+{
+    Position p(*this);
+
+    for (int r = 0; r < p.regions.size(); r++)
+    {
+        Region& region = p.regions[r];
+
+        for (int b = 0; b < region.size(); b++)
+        {
+            Boundary best = region[b];
+
+            for (int i = 1; i < region[b].size(); i++)
+            {
+                Boundary rotated(region[b].begin()+i, region[b].end());
+                rotated.insert(rotated.end(), region[b].begin(), region[b].begin()+i);
+
+                if (rotated < best)
+                    best = rotated;
+            }
+
+            region[b] = best;
+        }
+
+        sort(region.begin(), region.end());
+    }
+
+    sort(p.regions.begin(), p.regions.end());
+
+    return p;
+}
+
+ostream& operator<<(ostream& os, const Position& p)
+{
+    os << p.str();
+
+    return os;
+}
@@ -0,0 +1,201 @@
+/*
+*   The line crossing checks shared by the GUI and the AI
+*/
+#include <algorithm>
+#include "headers/segments.h"
+
+// Check this many segments at a time before stopping at a crossing, so the
+// inner loops don't have any branches
+static const int block = 64;
+
+// Start using the grid once there are this many segments
+static const int indexAt = 64;
+
+// Size of the grid squares in pixels, and the number of buckets they're
+// hashed into, which has to be a power of two
+static const int square = 32;
+static const int bucketCount = 1024;
+
+// Which square a coordinate is in, rounding down for negatives too
+static int squareOf(int v)
+{
+    return (v >= 0)?v/square:-((square - 1 - v)/square);
+}
+
+// The start of one of the arrays, which can be empty
+static const int* first(const vector<int>& v)
+{
+    return v.empty()?NULL:&v[0];
+}
+
+void Segments::Arrays::add(int p, int f, int t)
+{
+    pos.push_back(p);
+    from.push_back(f);
+    to.push_back(t);
+}
+
+void Segments::Arrays::clear()
+{
+    pos.clear();
+    from.clear();
+    to.clear();
+}
+
+// Segments going the other way at a position strictly between lo and hi on
+// the new segment's axis, with the new one's position strictly inside them
+bool Segments::across(const Arrays& a, int at, int lo, int hi)
+{
+    const int* pos = first(a.pos);
+    const int* from = first(a.from);
+    const int* to = first(a.to);
+    const int count = a.pos.size();
+
+    for (int start = 0; start < count; start += block)
+    {
+        const int end = (count - start < block)?count:start + block;
+        int hit = 0;
+
+        for (int i = start; i < end; i++)
+            hit |= (from[i] < at) & (at < to[i]) & (lo < pos[i]) & (pos[i] < hi);
+
+        if (hit)
+            return true;
+    }
+
+    return false;
+}
+
+// Segments going the same way at the same position that overlap the new one
+// from lo to hi by more than a point. If the new one is only a point, whether
+// it's strictly inside one.
+bool Segments::along(const Arrays& a, int at, int lo, int hi)
+{
+    const int* pos = first(a.pos);
+    const int* from = first(a.from);
+    const int* to = first(a.to);
+    const int count = a.pos.size();
+
+    for (int start = 0; start < count; start += block)
+    {
+        const int end = (count - start < block)?count:start + block;
+        int hit = 0;
+
+        for (int i = start; i < end; i++)
+            hit |= (pos[i] == at) & (lo < to[i]) & (from[i] < hi);
+
+        if (hit)
+            return true;
+    }
+
+    return false;
+}
+
+Segments::Segments(const Line& line, int points)
+{
+    for (int i = 1; i < points && i < line.size(); i++)
+        add(line[i-1], line[i]);
+}
+
+void Segments::clear()
+{
+    horizontal.clear();
+    vertical.clear();
+    buckets.clear();
+}
+
+void Segments::add(const Line& line)
+{
+    for (int i = 1; i < line.size(); i++)
+        add(line[i-1], line[i]);
+}
+
+void Segments::add(Coord a, Coord b)
+{
+    if (a.y == b.y)
+    {
+        horizontal.add(a.y, min(a.x, b.x), max(a.x, b.x));
+
+        if (!buckets.empty())
+            index(a.y, min(a.x, b.x), max(a.x, b.x), false);
+    }
+
+    if (a.x == b.x)
+    {
+        vertical.add(a.x, min(a.y, b.y), max(a.y, b.y));
+
+        if (!buckets.empty())
+            index(a.x, min(a.y, b.y), max(a.y, b.y), true);
+    }
+
+    if (buckets.empty() && size() >= indexAt)
+        index();
+}
+
+void Segments::index()
+{
+    buckets.assign(bucketCount, Bucket());
+
+    for (int i = 0; i < horizontal.pos.size(); i++)
+        index(horizontal.pos[i], horizontal.from[i], horizontal.to[i], false);
+
+    for (int i = 0; i < vertical.pos.size(); i++)
+        index(vertical.pos[i], vertical.from[i], vertical.to[i], true);
+}
+
+// Add it to the bucket of every square it goes through
+void Segments::index(int pos, int from, int to, bool isVertical)
+{
+    const int at = squareOf(pos);
+
+    for (int s = squareOf(from); s <= squareOf(to); s++)
+    {
+        if (isVertical)
+            bucket(at, s).vertical.add(pos, from, to);
+        else
+            bucket(s, at).horizontal.add(pos, from, to);
+    }
+}
+
+Segments::Bucket& Segments::bucket(int x, int y)
+{
+    return buckets[((unsigned int)x*73856093u ^ (unsigned int)y*19349663u) & (bucketCount - 1)];
+}
+
+const Segments::Bucket& Segments::bucket(int x, int y) const
+{
+    return buckets[((unsigned int)x*73856093u ^ (unsigned int)y*19349663u) & (bucketCount - 1)];
+}
+
+bool Segments::crosses(Coord a, Coord b, bool touch) const
+{
+    // Including the ends is the same as going one past them on integers
+    const int extra = touch?1:0;
+
+    // A point is checked as if it were a vertical segment
+    const bool isVertical = (a.x == b.x);
+    const int at = isVertical?a.x:a.y;
+    const int lo = isVertical?min(a.y, b.y):min(a.x, b.x);
+    const int hi = isVertical?max(a.y, b.y):max(a.x, b.x);
+    const Arrays& other = isVertical?horizontal:vertical;
+    const Arrays& same = isVertical?vertical:horizontal;
+
+    // Anything it crosses or touches is in one of the squares it goes
+    // through. If that's a lot of them, it's faster to look at everything.
+    const int firstSquare = squareOf(lo - extra);
+    const int lastSquare = squareOf(hi + extra);
+
+    if (buckets.empty() || (lastSquare - firstSquare + 1)*8 > size())
+        return across(other, at, lo - extra, hi + extra) || along(same, at, lo, hi);
+
+    for (int s = firstSquare; s <= lastSquare; s++)
+    {
+        const Bucket& found = isVertical?bucket(squareOf(at), s):bucket(s, squareOf(at));
+
+        if (across(isVertical?found.horizontal:found.vertical, at, lo - extra, hi + extra) ||
+            along(isVertical?found.vertical:found.horizontal, at, lo, hi))
+            return true;
+    }
+
+    return false;
+}
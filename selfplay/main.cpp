@@ -0,0 +1,108 @@
+/*
+*   Play the AI against itself without the GUI to see how fast the A-Checker
+*   and the AI are
+*
+*   Usage: selfplay [games] [spots] [milliseconds per move] [seed]
+*/
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+#include <iostream>
+#include <algorithm>
+#include "../headers/gameai.h"
+
+using namespace std;
+
+// Same size as the GUI's window
+static const int width = 800;
+static const int height = 600;
+
+// Where the GUI puts the spots, one in the center and the rest around an
+// ellipse, but turned and moved a bit differently each game
+static void placeSpots(GameAI& ai, int spots)
+{
+    double theta = 2*3.14*rand()/RAND_MAX;
+
+    if (spots > 0)
+        ai.insertNode(Coord(width/2, height/2));
+
+    for (int i = 1; i < spots; i++)
+    {
+        ai.insertNode(Coord(
+            width/3*cos(theta) + width/2 + rand()%21 - 10,
+            height/3*sin(theta) + height/2 + rand()%21 - 10));
+
+        theta += 2*3.14/spots;
+    }
+
+    ai.updateAreas();
+}
+
+// The time below which that fraction of the sorted times are
+static double percentile(const vector<double>& sorted, double fraction)
+{
+    if (sorted.empty())
+        return 0;
+
+    return sorted[(int)(fraction*(sorted.size()-1))];
+}
+
+int main(int argc, char* argv[])
+{
+    const int games = (argc > 1)?atoi(argv[1]):1000;
+    const int spots = (argc > 2)?atoi(argv[2]):3;
+    const int milliseconds = (argc > 3)?atoi(argv[3]):10;
+    const int seed = (argc > 4)?atoi(argv[4]):1;
+
+    vector<double> latencies; // Of each move in milliseconds
+    int firstWon = 0;
+    int stuck = 0; // The AI couldn't find a line for any move
+
+    const double start = wallClock();
+
+    for (int game = 0; game < games; game++)
+    {
+        GameAI ai;
+
+        srand(seed + game);
+        ai.setThinking(milliseconds, false);
+        placeSpots(ai, spots);
+
+        int moves = 0;
+
+        while (!ai.gameEnded())
+        {
+            const double before = wallClock();
+            const bool moved = ai.aiTurn();
+
+            latencies.push_back(wallClock() - before);
+
+            if (!moved)
+            {
+                ++stuck;
+                break;
+            }
+
+            ++moves;
+        }
+
+        if (ai.gameEnded() && moves%2 == 1)
+            ++firstWon;
+    }
+
+    const double seconds = (wallClock() - start)/1000;
+
+    sort(latencies.begin(), latencies.end());
+
+    cout << games << " games of " << spots << " spots, " << milliseconds
+         << " ms per move, seed " << seed << endl
+         << games/seconds << " games/s, " << latencies.size()/seconds << " moves/s" << endl
+         << "first player won " << firstWon << ", stuck " << stuck << endl
+         << "move latency (ms): min " << percentile(latencies, 0)
+         << ", median " << percentile(latencies, 0.5)
+         << ", 90% " << percentile(latencies, 0.9)
+         << ", 99% " << percentile(latencies, 0.99)
+         << ", max " << percentile(latencies, 1) << endl;
+
+    return 0;
+}
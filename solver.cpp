@@ -0,0 +1,458 @@
+#include <set>
+#include <algorithm>
+#include "headers/solver.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/time.h>
+#endif
+
+// Thrown inside the search when the time for this move is used up
+class OutOfTime { };
+
+// Bounds for the values in the table
+static const signed char Exact = 0;
+static const signed char Lower = 1; // At least this
+static const signed char Upper = 2; // At most this
+
+// Depth stored for wins and losses that are proven
+static const int Proven = 1 << 30;
+
+// Random numbers for the Zobrist hash from a fixed xorshift generator, so
+// hashes are the same every run, made as they're needed
+static unsigned long long zobrist(size_t i)
+{
+    static vector<unsigned long long> table;
+    static unsigned long long x = 88172645463325252ULL;
+
+    while (table.size() <= i)
+    {
+        x ^= x << 13;
+        x ^= x >> 7;
+        x ^= x << 17;
+        table.push_back(x);
+    }
+
+    return table[i];
+}
+
+// One number for each character at each place in the key, and one for the
+// size of the heap at the place after the key
+static unsigned long long hashOf(const string& key, int heap)
+{
+    unsigned long long h = zobrist(key.size()*256 + (heap & 255));
+
+    for (size_t i = 0; i < key.size(); i++)
+        h ^= zobrist(i*256 + (unsigned char)key[i]);
+
+    return h;
+}
+
+double wallClock()
+{
+#ifdef _WIN32
+    LARGE_INTEGER count, frequency;
+
+    QueryPerformanceCounter(&count);
+    QueryPerformanceFrequency(&frequency);
+
+    return 1000.0*count.QuadPart/frequency.QuadPart;
+#else
+    timeval now;
+
+    gettimeofday(&now, NULL);
+
+    return 1000.0*now.tv_sec + now.tv_usec/1000.0;
+#endif
+}
+
+// Each move uses up two lives and adds one, so a game can't go on longer than
+// there are lives on the vertices still in it
+static int livesIn(const Position& p)
+{
+    const vector<Region>& regions = p.getRegions();
+    vector<bool> counted(p.vertexCount(), false);
+    int lives = 0;
+
+    for (int r = 0; r < regions.size(); r++)
+    {
+        for (int b = 0; b < regions[r].size(); b++)
+        {
+            for (int i = 0; i < regions[r][b].size(); i++)
+            {
+                const int vertex = regions[r][b][i];
+
+                if (!counted[vertex])
+                {
+                    counted[vertex] = true;
+                    lives += p.livesLeft(vertex);
+                }
+            }
+        }
+    }
+
+    return lives;
+}
+
+Solver::Solver(int milliseconds, int tableBits, bool useBook)
+    :milliseconds(milliseconds), deadline(0), useBook(useBook), nodes(0), seconds(0),
+     finished(0), result(0)
+{
+    Entry empty = { "", 0, -1, 0, 0, Exact };
+    table.assign(1 << tableBits, empty);
+}
+
+bool Solver::inBook(const string& key) const
+{
+    static set<string> lost;
+
+    if (!useBook)
+        return false;
+
+    if (lost.empty())
+        for (int i = 0; book[i]; i++)
+            lost.insert(book[i]);
+
+    return lost.find(key) != lost.end();
+}
+
+// Higher values first, otherwise in the order they were
+static bool better(const pair<int, int>& a, const pair<int, int>& b)
+{
+    return a.first > b.first;
+}
+
+Solver::Entry& Solver::slot(const string& key, int heap)
+{
+    return table[hashOf(key, heap) & (table.size()-1)];
+}
+
+const Solver::Entry* Solver::find(const string& key, int heap) const
+{
+    const Entry& e = table[hashOf(key, heap) & (table.size()-1)];
+
+    return (e.heap == heap && e.key == key)?&e:NULL;
+}
+
+void Solver::children(const Position& p, vector<AbstractMove>& moves,
+    vector<Position>& positions, vector<string>& keys) const
+{
+    const vector<AbstractMove> all = p.moves();
+    set<string> seen;
+
+    moves.clear();
+    positions.clear();
+    keys.clear();
+
+    for (int i = 0; i < all.size(); i++)
+    {
+        const Position next = p.play(all[i]);
+        const string key = next.key();
+
+        if (seen.insert(key).second)
+        {
+            moves.push_back(all[i]);
+            positions.push_back(next);
+            keys.push_back(key);
+        }
+    }
+}
+
+// Look the slot up again rather than keeping it from before searching, since
+// the search may have moved things around in the table
+void Solver::store(const string& key, int heap, int depth, int best, int value, int alpha, int beta)
+{
+    Entry& e = slot(key, heap);
+    const signed char bound = (value <= alpha)?Upper:((value >= beta)?Lower:Exact);
+    const bool proven = (value == 1 && bound != Upper) || (value == -1 && bound != Lower);
+    const int stored = proven?Proven:depth;
+
+    if (e.heap != heap || e.key != key || stored >= e.depth)
+    {
+        e.key = key;
+        e.heap = heap;
+        e.depth = stored;
+        e.best = best;
+        e.value = value;
+        e.bound = bound;
+    }
+}
+
+int Solver::search(const Position& p, int heap, const string& key, int depth, int alpha, int beta)
+{
+
+    if ((++nodes & 1023) == 0 && deadline != 0 && wallClock() > deadline)
+        throw OutOfTime();
+
+    // Whoever can't move loses, and with only a heap left that's whoever
+    // doesn't get to empty it
+    if (p.ended())
+        return (heap == 0)?-1:1;
+
+    if (heap == 0 && inBook(key))
+        return -1;
+
+    const Entry* entry = find(key, heap);
+    int first = 0;
+
+    if (entry)
+    {
+        if (entry->depth >= depth &&
+            (entry->bound == Exact ||
+            (entry->bound == Lower && entry->value >= beta) ||
+            (entry->bound == Upper && entry->value <= alpha)))
+            return entry->value;
+
+        first = entry->best;
+    }
+
+    // When the position has come apart, only search the biggest part. The
+    // others play like nim heaps the size of their nimbers, and those together
+    // with the heap already here are the same as one heap of their XOR.
+    const vector<Position> parts = p.components();
+
+    if (parts.size() > 1)
+    {
+        int biggest = 0;
+        int most = -1;
+
+        for (int i = 0; i < parts.size(); i++)
+        {
+            const int lives = livesIn(parts[i]);
+
+            if (lives > most)
+            {
+                most = lives;
+                biggest = i;
+            }
+        }
+
+        int rest = heap;
+
+        for (int i = 0; i < parts.size(); i++)
+            if (i != biggest)
+                rest ^= partNimber(parts[i], parts[i].key());
+
+        const int value = search(parts[biggest], rest, parts[biggest].key(), depth, alpha, beta);
+
+        store(key, heap, depth, 0, value, alpha, beta);
+
+        return value;
+    }
+
+    if (depth == 0)
+        return 0;
+
+    vector<AbstractMove> moves;
+    vector<Position> positions;
+    vector<string> keys;
+
+    children(p, moves, positions, keys);
+
+    // Moves in the position keep the heap, and after them come taking some
+    // off the heap
+    vector<int> heaps(positions.size(), heap);
+
+    for (int smaller = 0; smaller < heap; smaller++)
+    {
+        positions.push_back(p);
+        keys.push_back(key);
+        heaps.push_back(smaller);
+    }
+
+    // Win right away if a move leaves a position already known to be lost
+    for (int i = 0; i < positions.size(); i++)
+    {
+        const Entry* child = find(keys[i], heaps[i]);
+
+        if ((heaps[i] == 0 && (positions[i].ended() || inBook(keys[i]))) ||
+            (child && child->depth == Proven && child->value == -1))
+        {
+            store(key, heap, Proven, i, 1, 0, 1);
+            return 1;
+        }
+    }
+
+    // Try the best move from last time first, and then the ones that split
+    // the position into the most parts, since those are quick to work out
+    // and they often win
+    vector<pair<int, int> > split;
+    vector<int> order;
+
+    if (first < positions.size())
+        order.push_back(first);
+
+    for (int i = 0; i < positions.size(); i++)
+        if (i != first)
+            split.push_back(make_pair(positions[i].components().size(), i));
+
+    stable_sort(split.begin(), split.end(), better);
+
+    for (int i = 0; i < split.size(); i++)
+        order.push_back(split[i].second);
+
+    const int original = alpha;
+    int best = -2;
+    int bestIndex = 0;
+
+    for (int i = 0; i < order.size(); i++)
+    {
+        const int index = order[i];
+        const int value = -search(positions[index], heaps[index], keys[index], depth-1, -beta, -alpha);
+
+        if (value > best)
+        {
+            best = value;
+            bestIndex = index;
+        }
+
+        if (best > alpha)
+            alpha = best;
+
+        if (alpha >= beta)
+            break;
+    }
+
+    store(key, heap, depth, bestIndex, best, original, beta);
+
+    return best;
+}
+
+int Solver::nimber(const Position& p)
+{
+    const vector<Position> parts = p.components();
+    int value = 0;
+
+    // No time limit outside of rank()
+    deadline = 0;
+
+    for (int i = 0; i < parts.size(); i++)
+        value ^= partNimber(parts[i], parts[i].key());
+
+    return value;
+}
+
+// A position with nimber n is lost next to a heap of n and won next to any
+// other heap, so it's the smallest heap that loses. Searching for that lets
+// alpha-beta skip most of the moves, where working it out from the nimbers of
+// every move would have to look at all of them.
+int Solver::partNimber(const Position& p, const string& key)
+{
+    const map<string, int>::const_iterator known = nimbers.find(key);
+
+    if (known != nimbers.end())
+        return known->second;
+
+    const int lives = livesIn(p);
+    int value = 0;
+
+    while (search(p, value, key, lives + value, -1, 0) >= 0)
+        ++value;
+
+    nimbers[key] = value;
+
+    return value;
+}
+
+vector<AbstractMove> Solver::rank(const Position& p)
+{
+    return rank(p, set<string>());
+}
+
+vector<AbstractMove> Solver::rank(const Position& p, const set<string>& leaving)
+{
+    const double start = wallClock();
+    vector<AbstractMove> moves;
+    vector<Position> positions;
+    vector<string> keys;
+
+    nodes = 0;
+    finished = 0;
+    result = -1;
+    deadline = start + milliseconds;
+
+    children(p, moves, positions, keys);
+
+    const int lives = livesIn(p);
+
+    // Values for the player to move, kept in the same order as the moves
+    // except that moves to positions in the book are already known to win
+    vector<pair<int, int> > values;
+
+    for (int i = 0; i < moves.size(); i++)
+        if (!leaving.count(keys[i]))
+            values.push_back(make_pair(inBook(keys[i])?1:0, i));
+
+    stable_sort(values.begin(), values.end(), better);
+
+    try
+    {
+        // Look for a win twice as deep each time. Unknown counts the same as
+        // a loss here, which lets alpha-beta cut off most of the tree. The
+        // last time is deep enough that everything is known, so then find
+        // the value of every move. Searching all the way is often quicker
+        // than searching most of the way, since then there's nothing unknown
+        // to get in the way of cutoffs, so go straight there after halfway.
+        int depth = 1;
+
+        while (!values.empty() && values.front().first != 1)
+        {
+            const int alpha = (depth < lives)?0:-1;
+
+            for (int i = 0; i < values.size(); i++)
+            {
+                const int index = values[i].second;
+
+                values[i].first = -search(positions[index], 0, keys[index], depth-1, -1, -alpha);
+
+                if (values[i].first == 1)
+                    break;
+            }
+
+            finished = depth;
+            stable_sort(values.begin(), values.end(), better);
+
+            if (values.front().first == 1 || depth == lives)
+                break;
+
+            depth = (depth*2 < lives)?depth*2:lives;
+        }
+    }
+    catch (const OutOfTime&)
+    {
+        stable_sort(values.begin(), values.end(), better);
+    }
+
+    seconds = (wallClock() - start)/1000;
+
+    vector<AbstractMove> ranked;
+
+    for (int i = 0; i < values.size(); i++)
+        ranked.push_back(moves[values[i].second]);
+
+    if (!values.empty())
+        result = values.front().first;
+
+    return ranked;
+}
+
+double Solver::nodesPerSecond() const
+{
+    return (seconds > 0)?nodes/seconds:0;
+}
+
+ostream& operator<<(ostream& os, const Solver& s)
+{
+    os << "depth " << s.depth() << ", " << s.nodesSearched() << " nodes, "
+       << (long)s.nodesPerSecond() << " nodes/s, ";
+
+    switch (s.value())
+    {
+        case 1:  os << "win"; break;
+        case -1: os << "loss"; break;
+        default: os << "unknown"; break;
+    }
+
+    return os;
+}
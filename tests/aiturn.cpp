@@ -0,0 +1,36 @@
+/*
+*   Test that the AI always finds a line to draw while there's a move left
+*/
+#include <cmath>
+#include <cstdlib>
+#include "tests.h"
+#include "../headers/gameai.h"
+
+void aiTurn()
+{
+    bool passed = true;
+
+    // Games of the AI against itself with the spots around a circle turned and
+    // moved a bit differently each time, but the same every run
+    for (unsigned int seed = 1; seed <= 200 && passed; seed++)
+    {
+        GameAI ai;
+
+        srand(seed);
+        ai.setThinking(10, false);
+
+        const double turned = 2*M_PI*rand()/RAND_MAX;
+
+        for (int i = 0; i < 3; i++)
+            ai.insertNode(Coord(400 + 200*cos(turned + 2*M_PI*i/3) + rand()%41 - 20,
+                                300 + 150*sin(turned + 2*M_PI*i/3) + rand()%41 - 20));
+
+        ai.updateAreas();
+
+        for (int moves = 0; !ai.gameEnded() && passed; moves++)
+            if (!ai.aiTurn() || ai.state().moves() != moves+1)
+                passed = false;
+    }
+
+    test("AI turn", passed);
+}
@@ -0,0 +1,50 @@
+/*
+*   Test the area index against looking at every line
+*/
+#include "tests.h"
+
+void areaIndex()
+{
+    bool passed = true;
+    Game game;
+    Line linea, lineb, linec;
+    Connection cona, conb, conc;
+
+    // A jagged loop from (0,0) with a notch cut into the right side
+    linea.push_back(Coord(0,0));
+    linea.push_back(Coord(40,0));
+    linea.push_back(Coord(40,10));
+
+    lineb.push_back(Coord(40,10));
+    lineb.push_back(Coord(20,10));
+    lineb.push_back(Coord(20,20));
+    lineb.push_back(Coord(40,20));
+    lineb.push_back(Coord(40,30));
+
+    linec.push_back(Coord(40,30));
+    linec.push_back(Coord(0,30));
+    linec.push_back(Coord(0,0));
+
+    cona.line = &linea;
+    conb.line = &lineb;
+    conc.line = &linec;
+
+    Area slow;
+    slow.push_back(&cona);
+    slow.push_back(&conb);
+    slow.push_back(&conc);
+
+    Area fast(slow);
+    fast.buildIndex();
+
+    // Including points on the lines and corners
+    for (int x = -5; x <= 45 && passed; x += 5)
+        for (int y = -5; y <= 35 && passed; y++)
+            if (game.isInArea(slow, Coord(x,y)) != game.isInArea(fast, Coord(x,y)))
+                passed = false;
+
+    if (!game.isInArea(fast, Coord(10,15)) || game.isInArea(fast, Coord(30,15)))
+        passed = false;
+
+    test("areaIndex", passed);
+}
@@ -0,0 +1,71 @@
+/*
+*   Test keeping track of the parts of the screen to show
+*/
+#include "tests.h"
+
+// Whether r is at x, y and w by h
+static bool at(const SDL_Rect& r, int x, int y, int w, int h)
+{
+    return r.x == x && r.y == y && r.w == w && r.h == h;
+}
+
+void damage()
+{
+    bool passed = true;
+    Damage d;
+
+    // Cut to the screen, and left off if it's not on it at all
+    d.add(-5, -5, 10, 20);
+    d.add(95, 40, 10, 10);
+    d.add(200, 0, 10, 10);
+    d.add(10, 10, 0, 5);
+
+    vector<SDL_Rect> shown = d.on(100, 100);
+
+    if (shown.size() != 2 || !at(shown[0], 0, 0, 5, 15) || !at(shown[1], 95, 40, 5, 10))
+        passed = false;
+
+    // Most of the screen is all of it
+    d.add(0, 0, 100, 60);
+    shown = d.on(100, 100);
+
+    if (shown.size() != 1 || !at(shown[0], 0, 0, 100, 100))
+        passed = false;
+
+    d.clear();
+
+    if (!d.empty() || !d.on(100, 100).empty())
+        passed = false;
+
+    d.addAll();
+    shown = d.on(100, 100);
+
+    if (d.empty() || shown.size() != 1 || !at(shown[0], 0, 0, 100, 100))
+        passed = false;
+
+    // Where two pages differ
+    SDL_Surface* a = SDL_CreateRGBSurface(SDL_SWSURFACE, 40, 30, 32, 0, 0, 0, 0);
+    SDL_Surface* b = SDL_CreateRGBSurface(SDL_SWSURFACE, 40, 30, 32, 0, 0, 0, 0);
+    SDL_Rect changed;
+
+    if (!a || !b)
+    {
+        passed = false;
+    }
+    else
+    {
+        if (!Damage::difference(a, b, changed) || changed.w != 0 || changed.h != 0)
+            passed = false;
+
+        static_cast<Uint32*>(b->pixels)[5*b->pitch/4 + 7] = 1;
+        static_cast<Uint32*>(b->pixels)[9*b->pitch/4 + 3] = 1;
+
+        if (!Damage::difference(a, b, changed) || !at(changed, 3, 5, 5, 5))
+            passed = false;
+    }
+
+    SDL_FreeSurface(a);
+    SDL_FreeSurface(b);
+
+    test("damage", passed);
+}
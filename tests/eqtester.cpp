@@ -50,4 +50,39 @@ void eqtester()
 
     passOne = (areaa==areab);
     test("backward Area equality", passOne);
+
+    // Backward starting somewhere other than the first line
+    areab.clear();
+
+    areab.push_back(&otherc);
+    areab.push_back(&otherd);
+    areab.push_back(&othera);
+    areab.push_back(&otherb);
+
+    passOne = (areaa==areab);
+    test("rotated backward Area equality", passOne);
+
+    // Once canonical, the order and hash should be the same
+    areac = areab;
+    areaa.canonicalize();
+    areac.canonicalize();
+
+    passOne = (areaa==areac && areaa.hash()==areac.hash());
+
+    for (int i = 0; i < areaa.size(); i++)
+        if (areaa[i]->line != areac[i]->line)
+            passOne = false;
+
+    test("canonical Area equality", passOne);
+
+    // Same lines in a different order isn't the same circuit
+    areac.clear();
+
+    areac.push_back(&cona);
+    areac.push_back(&conc);
+    areac.push_back(&conb);
+    areac.push_back(&cond);
+
+    passOne = (areaa!=areac && areab!=areac);
+    test("Area inequality", passOne);
 }
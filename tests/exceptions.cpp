@@ -1,3 +1,4 @@
+#include <algorithm>
 #include "tests.h"
 
 void Tests::invalidCorner()
@@ -95,6 +96,135 @@ void Tests::invalidLine()
     test("invalidLine", passed);
 }
 
+void Tests::rejectedLoop()
+{
+    bool passed = false;
+
+    // A line from A going down, so A's next line has to go up
+    Node& a = insertNode(Coord(0,0));
+    insertNode(Coord(0,40));
+
+    Line down;
+    down.push_back(Coord(0,0));
+    down.push_back(Coord(0,40));
+    doMove(down, Coord(0,20));
+
+    // A loop that leaves up but comes back from below, where the first line
+    // already is, which is only found after it's been added to A once
+    Line loop;
+    loop.push_back(Coord(0,0));
+    loop.push_back(Coord(0,-10));
+    loop.push_back(Coord(10,-10));
+    loop.push_back(Coord(10,10));
+    loop.push_back(Coord(0,10));
+    loop.push_back(Coord(0,0));
+
+    try
+    {
+        doMove(loop, Coord(5,-10));
+    }
+    catch (const NodeEntryCollision& e)
+    {
+        passed = true;
+    }
+    catch (...)
+    {
+    }
+
+    // It should be as if it was never tried
+    const Connection* connections = a.getConnAddr();
+
+    if (nodes.size() != 3 || lines.size() != 2 || a.conCount() != 1 ||
+        a.openDown() || !a.openUp() || !a.openLeft() || !a.openRight())
+        passed = false;
+
+    for (int i = 0; i < 3; i++)
+        if (connections[i].exists() &&
+            find(lines.begin(), lines.end(), connections[i].line) == lines.end())
+            passed = false;
+
+    test("rejectedLoop", passed);
+}
+
+// Whether doMove() throws what checkMove() said it would, leaving the game
+// the way it was
+template<class T> static bool rejected(Game& g, MoveCheck check,
+    const Line& line, Coord middle)
+{
+    const GameState before = g.state();
+
+    if (g.checkMove(line, middle) != check)
+        return false;
+
+    try
+    {
+        g.doMove(line, middle);
+    }
+    catch (const T&)
+    {
+        return g.state() == before;
+    }
+    catch (...)
+    {
+    }
+
+    return false;
+}
+
+void Tests::moveChecks()
+{
+    bool passed = true;
+    Line l;
+
+    insertNode(Coord(0,0));
+    insertNode(Coord(10,10));
+    updateAreas();
+
+    // Doesn't end on a node
+    l.push_back(Coord(0,0));
+    l.push_back(Coord(0,20));
+
+    if (!rejected<InvalidNode>(*this, MoveInvalidNode, l, Coord(0,10)))
+        passed = false;
+
+    // Middle isn't on the line
+    l.back() = Coord(0,10);
+    l.push_back(Coord(10,10));
+
+    if (!rejected<InvalidMiddle>(*this, MoveInvalidMiddle, l, Coord(5,5)))
+        passed = false;
+
+    // Fine, and checking doesn't change anything
+    const GameState before = state();
+
+    if (checkMove(l, Coord(5,10)) != MoveOK || !(state() == before))
+        passed = false;
+
+    doMove(l, Coord(5,10));
+
+    // Leaving the bottom of (0,0) again
+    l.clear();
+    l.push_back(Coord(0,0));
+    l.push_back(Coord(0,20));
+    l.push_back(Coord(10,20));
+    l.push_back(Coord(10,10));
+
+    if (!rejected<NodeEntryCollision>(*this, MoveEntryCollision, l, Coord(5,20)))
+        passed = false;
+
+    // Leaving the right of (0,0), which is a corner with the bottom
+    l.clear();
+    l.push_back(Coord(0,0));
+    l.push_back(Coord(20,0));
+    l.push_back(Coord(20,10));
+    l.push_back(Coord(10,10));
+
+    if (!rejected<InvalidCorner>(*this, MoveInvalidCorner, l, Coord(10,0)))
+        passed = false;
+
+    test("moveChecks", passed && moves() == 1);
+}
+
 void Tests::imageNotLoaded()
 {
     bool passed = false;
@@ -333,4 +333,9 @@ void copyConstructor()
     t4 = t;
     t4.updateAreas();
     test("copyAssignment 2", t4.validateCopy());
+
+    GameState s = t.state();
+    Tests t5(s);
+    t5.updateAreas();
+    test("copyState 1", t5.validateCopy() && t5.state() == s);
 }
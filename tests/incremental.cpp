@@ -0,0 +1,194 @@
+#include "tests.h"
+
+// Play game2 again, but check every incremental area update against a full
+// rebuild of the areas.
+void Tests::incremental(AreaFinder finder, const string& name)
+{
+    bool passed = true;
+
+    areaFinder(finder);
+    incrementalAreas(true, true);
+
+    insertNode(Coord(10,60));
+    insertNode(Coord(20,30));
+    insertNode(Coord(50,30));
+    insertNode(Coord(60,60));
+    updateAreas();
+
+    try
+    {
+        // Move 1
+        Line l;
+        l.push_back(Coord(10,60));
+        l.push_back(Coord(20,60));
+        l.push_back(Coord(20,30));
+
+        doMove(l, Coord(20,50));
+
+        // Move 2
+        l.clear();
+        l.push_back(Coord(20,50));
+        l.push_back(Coord(50,50));
+        l.push_back(Coord(50,30));
+
+        doMove(l, Coord(50,40));
+
+        // Move 3
+        l.clear();
+        l.push_back(Coord(20,30));
+        l.push_back(Coord(20,20));
+        l.push_back(Coord(35,20));
+        l.push_back(Coord(35,40));
+        l.push_back(Coord(50,40));
+
+        doMove(l, Coord(30,20));
+
+        // Move 4
+        l.clear();
+        l.push_back(Coord(30,20));
+        l.push_back(Coord(30,10));
+        l.push_back(Coord(50,10));
+        l.push_back(Coord(50,30));
+
+        doMove(l, Coord(40,10));
+
+        // Move 5, a loop from the outside node back to itself around a new
+        // node
+        Node& inside = insertNode(Coord(65,60));
+        updateAreas();
+
+        l.clear();
+        l.push_back(Coord(60,60));
+        l.push_back(Coord(60,70));
+        l.push_back(Coord(70,70));
+        l.push_back(Coord(70,50));
+        l.push_back(Coord(60,50));
+        l.push_back(Coord(60,60));
+
+        doMove(l, Coord(65,70));
+
+        // Move 6 and 7, go around everything so that the regions inside of
+        // the other loops are surrounded by a new area
+        Node& top = insertNode(Coord(0,0));
+        Node& bottom = insertNode(Coord(0,100));
+        updateAreas();
+
+        l.clear();
+        l.push_back(Coord(0,0));
+        l.push_back(Coord(-10,0));
+        l.push_back(Coord(-10,100));
+        l.push_back(Coord(0,100));
+
+        doMove(l, Coord(-10,50));
+
+        l.clear();
+        l.push_back(Coord(0,0));
+        l.push_back(Coord(100,0));
+        l.push_back(Coord(100,100));
+        l.push_back(Coord(0,100));
+
+        doMove(l, Coord(100,50));
+
+        if (connectable(top, inside) || !connectable(top, bottom))
+            passed = false;
+    }
+    catch (const AreasMismatch& e)
+    {
+        passed = false;
+    }
+    catch (...)
+    {
+        passed = false;
+    }
+
+    test("incremental " + name, passed);
+}
+
+// Play the first four moves of game2, take them all back checking that the
+// game is the same as before each one, and then play them again. Verifying
+// the areas while replaying makes sure the areas that were put back are right.
+void Tests::undo(AreaFinder finder, const string& name)
+{
+    bool passed = true;
+    vector<Line> moves;
+    vector<Coord> middles;
+    vector<GameState> states;
+
+    areaFinder(finder);
+    incrementalAreas(true, true);
+
+    insertNode(Coord(10,60));
+    insertNode(Coord(20,30));
+    insertNode(Coord(50,30));
+    insertNode(Coord(60,60));
+    updateAreas();
+
+    Line l;
+    l.push_back(Coord(10,60));
+    l.push_back(Coord(20,60));
+    l.push_back(Coord(20,30));
+    moves.push_back(l);
+    middles.push_back(Coord(20,50));
+
+    l.clear();
+    l.push_back(Coord(20,50));
+    l.push_back(Coord(50,50));
+    l.push_back(Coord(50,30));
+    moves.push_back(l);
+    middles.push_back(Coord(50,40));
+
+    l.clear();
+    l.push_back(Coord(20,30));
+    l.push_back(Coord(20,20));
+    l.push_back(Coord(35,20));
+    l.push_back(Coord(35,40));
+    l.push_back(Coord(50,40));
+    moves.push_back(l);
+    middles.push_back(Coord(30,20));
+
+    l.clear();
+    l.push_back(Coord(30,20));
+    l.push_back(Coord(30,10));
+    l.push_back(Coord(50,10));
+    l.push_back(Coord(50,30));
+    moves.push_back(l);
+    middles.push_back(Coord(40,10));
+
+    try
+    {
+        for (int i = 0; i < moves.size(); i++)
+        {
+            states.push_back(state());
+            doMove(moves[i], middles[i]);
+        }
+
+        for (int i = moves.size() - 1; i >= 0; i--)
+        {
+            undoMove();
+
+            Tests full(*this);
+            full.updateAreas();
+
+            if (state() != states[i] || !sameAreas(full))
+                passed = false;
+        }
+
+        try
+        {
+            undoMove();
+            passed = false;
+        }
+        catch (const NoMoveToUndo& e)
+        {
+        }
+
+        for (int i = 0; i < moves.size(); i++)
+            doMove(moves[i], middles[i]);
+    }
+    catch (...)
+    {
+        passed = false;
+    }
+
+    test("undo " + name, passed);
+}
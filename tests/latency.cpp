@@ -0,0 +1,32 @@
+/*
+*   Test the input latency histogram
+*/
+#include <sstream>
+#include "tests.h"
+
+void latency()
+{
+    bool passed = true;
+
+    // Buckets double in size, with the last one for everything longer
+    if (Latency::bucket(0) != 0 || Latency::bucket(1) != 1 || Latency::bucket(2) != 2 ||
+        Latency::bucket(3) != 2 || Latency::bucket(4) != 3 || Latency::bucket(255) != 8 ||
+        Latency::bucket(256) != 9 || Latency::bucket(100000) != Latency::buckets - 1)
+        passed = false;
+
+    // Only the types of events there were are printed
+    Latency l;
+    l.add(SDL_MOUSEMOTION, 0);
+    l.add(SDL_MOUSEMOTION, 5);
+    l.skipped(3);
+
+    ostringstream s;
+    l.print(s);
+
+    if (s.str().find("mouse motion         2       1       0       0       1") == string::npos ||
+        s.str().find("button up") != string::npos ||
+        s.str().find("3 mouse motion events skipped") == string::npos)
+        passed = false;
+
+    test("latency", passed);
+}
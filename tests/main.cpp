@@ -6,11 +6,26 @@ int main()
     Tests().game2();
     Tests().jaggedLine();
     Tests().game1_doMove();
+    Tests().incremental(WalkAreas, "walk");
+    Tests().incremental(TraceAreas, "trace");
+    Tests().undo(WalkAreas, "walk");
+    Tests().undo(TraceAreas, "trace");
     Tests().invalidCorner();
     Tests().invalidLine();
+    Tests().rejectedLoop();
+    Tests().moveChecks();
     Tests().imageNotLoaded();
     copyConstructor();
     eqtester();
+    areaIndex();
+    segmentCrossing();
+    nodeGrid();
+    damage();
+    latency();
+    position();
+    solver();
+    aiTurn();
+    differential();
 
     return 0;
 }
@@ -0,0 +1,61 @@
+/*
+*   Test finding nodes by where they are against looking at all of them
+*/
+#include <cstdlib>
+#include <algorithm>
+#include "tests.h"
+
+void nodeGrid()
+{
+    bool passed = true;
+    NodeGrid grid;
+    vector<Coord> points;
+
+    srand(1);
+
+    // Enough to go through a few rehashes, with some at the same point and
+    // some at negative coordinates
+    for (int i = 0; i < 300 && passed; i++)
+    {
+        const Coord point = (i%10 == 9)?points[rand()%points.size()]:
+            Coord(rand()%400 - 100, rand()%400 - 100);
+
+        grid.add(point);
+        points.push_back(point);
+
+        if (i%3 == 2)
+        {
+            grid.removeLast();
+            points.pop_back();
+        }
+
+        // Exact lookups
+        const Coord probe = points[rand()%points.size()];
+        int count = 0;
+        const int found = grid.find(probe, &count);
+
+        if (found != find(points.begin(), points.end(), probe) - points.begin() ||
+            count != std::count(points.begin(), points.end(), probe))
+            passed = false;
+
+        // Rectangles, small and large
+        const Coord from(rand()%400 - 100, rand()%400 - 100);
+        const int size = (i%2 == 0)?20:300;
+        const Coord to(from.x + rand()%size, from.y + rand()%size);
+        vector<int> inside;
+        vector<int> expected;
+
+        grid.findIn(from, to, inside);
+        sort(inside.begin(), inside.end());
+
+        for (int j = 0; j < points.size(); j++)
+            if (points[j].x >= from.x && points[j].x <= to.x &&
+                points[j].y >= from.y && points[j].y <= to.y)
+                expected.push_back(j);
+
+        if (inside != expected)
+            passed = false;
+    }
+
+    test("nodeGrid", passed && grid.find(Coord(1000,1000)) == -1);
+}
@@ -0,0 +1,73 @@
+/*
+*   Test the abstract positions the AI plays on and turning their moves back
+*   into lines
+*/
+#include "tests.h"
+#include "../headers/gameai.h"
+
+// Whether the player to move can win with perfect play
+static bool wins(const Position& p)
+{
+    vector<AbstractMove> moves = p.moves();
+
+    for (int i = 0; i < moves.size(); i++)
+        if (!wins(p.play(moves[i])))
+            return true;
+
+    return false;
+}
+
+void position()
+{
+    bool passed = true;
+    Position start(3);
+
+    // A loop at each spot around any of the others, or a line to another one
+    if (start.str() != "0.0.0}!" || start.moves().size() != 15)
+        passed = false;
+
+    test("position 1", passed);
+
+    // Known results for small games, the first player loses with one or two
+    // spots and wins with three
+    test("position 2", !wins(Position(1)) && !wins(Position(2)) && wins(Position(3)));
+
+    // A loop at the first spot going around the second but not the third
+    passed = true;
+    GameAI ai;
+    ai.insertNode(Coord(100,100));
+    ai.insertNode(Coord(300,100));
+    ai.insertNode(Coord(200,250));
+    ai.updateAreas();
+
+    AbstractMove loop;
+    loop.group.push_back(true);
+    loop.group.push_back(false);
+
+    try
+    {
+        Coord middle;
+        Position before(ai.state());
+        Line line = ai.findLine(loop, middle);
+
+        ai.doMove(line, middle);
+
+        if (Position(ai.state()) != before.play(loop) || Position(ai.state()) == Position(3))
+            passed = false;
+
+        // Then any move after that
+        Position after(ai.state());
+        AbstractMove move = after.moves().back();
+        line = ai.findLine(move, middle);
+        ai.doMove(line, middle);
+
+        if (Position(ai.state()) != after.play(move))
+            passed = false;
+    }
+    catch (...)
+    {
+        passed = false;
+    }
+
+    test("position 3", passed);
+}
@@ -0,0 +1,227 @@
+/*
+*   Generate random games and play them with different ways of finding the
+*   areas, which should always agree on what's connectable
+*/
+#include <cstdlib>
+#include "tests.h"
+#include "../headers/gameai.h"
+
+// Pick a move at random without listing them all, since there are
+// exponentially many loops once a region has a lot of boundaries. Returns
+// false if it picked a vertex to itself that doesn't have the lives for it.
+static bool randomMove(const Position& p, AbstractMove& move)
+{
+    const vector<Region>& regions = p.getRegions();
+    const int r = rand()%regions.size();
+    const Region& region = regions[r];
+
+    move.region = r;
+    move.boundary1 = rand()%region.size();
+    move.index1 = rand()%region[move.boundary1].size();
+    move.boundary2 = rand()%region.size();
+    move.index2 = rand()%region[move.boundary2].size();
+
+    // In the same order as Position::moves()
+    if (move.boundary2 < move.boundary1 ||
+        (move.boundary2 == move.boundary1 && move.index2 < move.index1))
+    {
+        swap(move.boundary1, move.boundary2);
+        swap(move.index1, move.index2);
+    }
+
+    const int start = region[move.boundary1][move.index1];
+
+    if (start == region[move.boundary2][move.index2] && p.livesLeft(start) < 2)
+        return false;
+
+    // Loops around a lot of boundaries that are all over usually can't be
+    // drawn, so only go around one or two at a time on average
+    move.group.clear();
+
+    if (move.boundary1 == move.boundary2)
+        for (int i = 0; i < region.size()-1; i++)
+            move.group.push_back(rand()%(region.size()+1) < 2);
+
+    return true;
+}
+
+RandomGame randomGame(int spots, int moves, unsigned int seed)
+{
+    RandomGame game;
+    GameAI ai;
+    int columns = 1;
+
+    srand(seed);
+
+    while (columns*columns < spots)
+        ++columns;
+
+    // A grid with some room between the spots, moved around a bit
+    for (int i = 0; i < spots; i++)
+    {
+        game.spots.push_back(Coord(
+            150*(1 + i%columns) + rand()%61 - 30,
+            150*(1 + i/columns) + rand()%61 - 30));
+        ai.insertNode(game.spots.back());
+    }
+
+    ai.updateAreas();
+
+    // Give up once there hasn't been room for a while. Spots with one line
+    // have to be left straight out the other side, so a lot of moves that are
+    // fine in the abstract can't be drawn where things are crowded.
+    for (int tries = 0; game.lines.size() < moves && tries < 50; tries++)
+    {
+        const Position p(ai.state());
+        AbstractMove move;
+
+        if (p.ended())
+            break;
+
+        if (!randomMove(p, move))
+            continue;
+
+        try
+        {
+            Coord middle;
+            Line line = ai.findLine(move, middle);
+
+            ai.doMove(line, middle);
+            game.lines.push_back(line);
+            game.middles.push_back(middle);
+            tries = -1;
+        }
+        catch (const NoLineFound&)
+        {
+
+        }
+    }
+
+    return game;
+}
+
+// Whether both games say the same nodes are connectable, with the nodes
+// matched up by where they are
+static bool sameConnectable(const Game& a, const Game& b)
+{
+    const GameState s = a.state();
+
+    if (s.nodeCount() != b.state().nodeCount() || a.gameEnded() != b.gameEnded())
+        return false;
+
+    for (int i = 0; i < s.nodeCount(); i++)
+    {
+        for (int j = i; j < s.nodeCount(); j++)
+        {
+            const Node* ai = a.findNode(s.loci(i));
+            const Node* aj = a.findNode(s.loci(j));
+            const Node* bi = b.findNode(s.loci(i));
+            const Node* bj = b.findNode(s.loci(j));
+
+            if (!bi || !bj || a.connectable(*ai, *aj) != b.connectable(*bi, *bj))
+                return false;
+        }
+    }
+
+    return true;
+}
+
+// Whether the partners Game keeps for each node are the same as asking
+// connectable() about every other node
+static bool partnersMatch(const Game& g)
+{
+    const GameState s = g.state();
+
+    for (int i = 0; i < s.nodeCount(); i++)
+    {
+        const Node& node = *g.findNode(s.loci(i));
+        vector<int> expected;
+
+        for (int j = 0; j < s.nodeCount(); j++)
+            if (g.connectable(node, *g.findNode(s.loci(j))))
+                expected.push_back(j);
+
+        if (g.connectablePartners(node) != expected)
+            return false;
+    }
+
+    return g.anyMovesLeft() == !g.gameEnded();
+}
+
+// Play the game in each of them, comparing the first to the others after
+// every move, and then take the moves back in the first one
+static bool differentialReplay(const RandomGame& game, vector<Game*>& games)
+{
+    try
+    {
+        for (int g = 0; g < games.size(); g++)
+        {
+            for (int i = 0; i < game.spots.size(); i++)
+                games[g]->insertNode(game.spots[i]);
+
+            games[g]->updateAreas();
+        }
+
+        for (int m = 0; m < game.lines.size(); m++)
+        {
+            for (int g = 0; g < games.size(); g++)
+                games[g]->doMove(game.lines[m], game.middles[m]);
+
+            for (int g = 0; g < games.size(); g++)
+                if (!partnersMatch(*games[g]) || (g > 0 && !sameConnectable(*games[0], *games[g])))
+                    return false;
+        }
+
+        for (int m = 0; m < game.lines.size(); m++)
+        {
+            games[0]->undoMove();
+
+            if (!partnersMatch(*games[0]))
+                return false;
+        }
+    }
+    catch (...)
+    {
+        return false;
+    }
+
+    return true;
+}
+
+void differential()
+{
+    bool passed = true;
+
+    // Small games played all the way through, with areas found incrementally
+    // by tracing faces, incrementally by walking circuits, and from scratch
+    for (int seed = 1; seed <= 10 && passed; seed++)
+    {
+        const RandomGame game = randomGame(2 + seed%5, 100, seed);
+        Game trace, walk, full;
+        vector<Game*> games;
+
+        walk.areaFinder(WalkAreas);
+        full.incrementalAreas(false);
+
+        games.push_back(&trace);
+        games.push_back(&walk);
+        games.push_back(&full);
+
+        if (game.lines.empty() || !differentialReplay(game, games))
+            passed = false;
+    }
+
+    test("differential 1", passed);
+
+    // A longer game, without walking circuits since that gets exponentially
+    // slower with the number of loops
+    const RandomGame game = randomGame(16, 24, 1);
+    Game trace, full;
+    vector<Game*> games;
+
+    full.incrementalAreas(false);
+    games.push_back(&trace);
+    games.push_back(&full);
+
+    test("differential 2", game.lines.size() >= 16 && differentialReplay(game, games));
+}
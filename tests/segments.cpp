@@ -0,0 +1,52 @@
+/*
+*   Test checking whether a new segment crosses the lines
+*/
+#include "tests.h"
+
+void segmentCrossing()
+{
+    bool passed = true;
+    Segments drawn;
+    Line line;
+
+    // A line going right, down, and back left, like a bracket
+    line.push_back(Coord(0,0));
+    line.push_back(Coord(20,0));
+    line.push_back(Coord(20,20));
+    line.push_back(Coord(0,20));
+    drawn.add(line);
+
+    // Through the middle of the right side, and through its end
+    if (!drawn.crosses(Coord(10,10), Coord(30,10)) || drawn.crosses(Coord(0,-10), Coord(0,10)))
+        passed = false;
+
+    // Stopping on a line only counts if touching does
+    if (drawn.crosses(Coord(30,10), Coord(20,10)) || !drawn.crosses(Coord(30,10), Coord(20,10), true))
+        passed = false;
+
+    // Meeting a line where it ends is fine, since that's a node
+    if (drawn.crosses(Coord(-10,0), Coord(0,0), true))
+        passed = false;
+
+    // Running along part of a line or exactly on one, but not continuing it
+    if (!drawn.crosses(Coord(10,0), Coord(30,0)) || !drawn.crosses(Coord(20,0), Coord(20,20)) ||
+        drawn.crosses(Coord(0,20), Coord(-10,20)))
+        passed = false;
+
+    // The first so many points of a line
+    if (Segments(line, 2).crosses(Coord(10,10), Coord(30,10)) || Segments(line, 2).size() != 1)
+        passed = false;
+
+    // Enough for the grid to be used, including at negative coordinates
+    Segments many;
+
+    for (int x = -1000; x < 1000; x += 10)
+        many.add(Coord(x,0), Coord(x,5));
+
+    if (!many.crosses(Coord(-15,3), Coord(-5,3)) || many.crosses(Coord(-19,3), Coord(-11,3)) ||
+        !many.crosses(Coord(-19,3), Coord(-10,3), true) || many.crosses(Coord(-19,3), Coord(-10,3)) ||
+        !many.crosses(Coord(500,-5), Coord(500,2)) || many.crosses(Coord(505,-5), Coord(505,10)))
+        passed = false;
+
+    test("segmentCrossing", passed);
+}
@@ -0,0 +1,33 @@
+/*
+*   Test the game tree search on small games with known results
+*/
+#include "tests.h"
+#include "../headers/solver.h"
+
+void solver()
+{
+    bool passed = true;
+    Solver search;
+
+    // The first player loses with one or two spots and wins with three or four
+    for (int spots = 1; spots <= 4; spots++)
+    {
+        search.rank(Position(spots));
+
+        if (search.value() != ((spots <= 2)?-1:1))
+            passed = false;
+    }
+
+    test("solver 1", passed);
+
+    // The best move with three spots leaves a position the other player loses
+    Position start(3);
+    vector<AbstractMove> moves = search.rank(start);
+
+    search.rank(start.play(moves.front()));
+    test("solver 2", search.value() == -1);
+
+    // Nimbers of the same games, zero exactly when the player to move loses
+    test("solver 3", search.nimber(Position(1)) == 0 && search.nimber(Position(2)) == 0 &&
+        search.nimber(Position(3)) == 1 && search.nimber(Position(4)) == 1);
+}
@@ -2,12 +2,15 @@
 #define H_TESTS
 
 #include <string>
+#include <vector>
 #include <iostream>
 #include <SDL.h>
 #include <SDL_image.h>
 #include <SDL_gfxPrimitives.h>
 #include "../headers/game.h"
 #include "../headers/image.h"
+#include "../headers/damage.h"
+#include "../headers/latency.h"
 
 using namespace std;
 
@@ -17,13 +20,18 @@ class Tests : public Game
         // This is inherited from Game because this is testing it as if it were
         // GameGUI, using user input.
         Tests() :Game() { }
+        Tests(const GameState& s) :Game(s) { }
 
         void game1();
         void game2();
         void jaggedLine();
         void game1_doMove();
+        void incremental(AreaFinder, const string&);
+        void undo(AreaFinder, const string&);
         void invalidCorner();
         void invalidLine();
+        void rejectedLoop();
+        void moveChecks();
         void imageNotLoaded();
 
         // Initialize game for the copyConstructor test
@@ -44,4 +52,45 @@ void test(const string& s, bool passed);
 //test area eqlaity
 void eqtester();
 
+// Test the area index used by isInArea()
+void areaIndex();
+
+// Test checking if new segments cross the lines
+void segmentCrossing();
+
+// Test finding nodes by where they are
+void nodeGrid();
+
+// Test keeping track of the parts of the screen to show
+void damage();
+
+// Test the input latency histogram
+void latency();
+
+// Test the abstract positions used by the AI
+void position();
+
+// Test the AI's game tree search
+void solver();
+
+// Test that the AI always has a line to draw until the game ends
+void aiTurn();
+
+// A random legal game: where the spots start and the lines and middle nodes
+// of the moves after that. It's the same every time for a seed. Moves are
+// picked at random from the abstract position and drawn with the AI's line
+// finder, so there may be fewer than asked for if it runs out of room.
+struct RandomGame
+{
+    vector<Coord> spots;
+    vector<Line> lines;
+    vector<Coord> middles;
+};
+
+RandomGame randomGame(int spots, int moves, unsigned int seed);
+
+// Play random games with different ways of finding areas and check that they
+// agree on which nodes are connectable after every move
+void differential();
+
 #endif